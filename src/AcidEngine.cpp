@@ -1,5 +1,12 @@
 #include "plugin.hpp"
+#include "AcidModes.hpp"
+#include "AcidEngineCommon.hpp"
 #include "open303/rosic_Open303.h"
+#include "open303/rosic_WaveFileReader.h"
+#include "open303/rosic_DenormalGuard.h"
+#include <osdialog.h>
+#include <atomic>
+#include <mutex>
 
 using namespace rosic;
 
@@ -45,14 +52,49 @@ struct AcidEngine : Module {
 
 	float sampleRate = 44100.f;
 	int active_note = 60;
-	float vuLevel = 0.f;
-
-	int controlCounter = 0;
-	static const int controlRate = 32;
-	float cachedSlide = 0.f;
-	bool cachedAccentTriggered = false;
-
 
+	// VU meter: the peak is collected per sample, the level and lights follow at UI rate
+	float vuPeak = 0.f;
+	float vuLevel = 0.f;
+	static constexpr float vuDecayPerSecond = 4.41f; // full scale to zero in ~230ms
+	dsp::ClockDivider lightDivider;
+
+	int controlCounter = controlRate - 1; // the first frame pushes the knobs
+	static const int controlRate = 128;
+
+	// Engine values computed by the control block, and the ones last pushed into the engine
+	EngineParameters parameters;
+	EngineParameters lastParameters;
+	float lastTuning = INFINITY; // knob value that parameters.tuningHz was computed from
+
+	// Sleep state: while the voice is idle and the gate is low, process() only watches for a
+	// trigger and (at control rate) for touched parameters or pending engine changes
+	bool sleeping = false;
+	float sleepParams[PARAMS_LEN] = {};
+
+	// User waveform (replaces the saw). Loaded on the UI thread, resampled and mip-mapped on the
+	// wavetable rebuild thread; the audio thread only switches tables at block boundaries.
+	static const int maxUserWaveformLength = 16384;
+	std::mutex userWaveformMutex;
+	std::vector<float> userWaveform; // as loaded, saved with the patch
+	std::string userWaveformName;
+	std::atomic<bool> hasUserWaveform{false};
+	std::atomic<bool> userWaveformChanged{false};
+
+	// Engine option: the filter/amp modulation chain is evaluated every N samples and interpolated
+	// in between (1 = every sample). Set from the UI thread, applied at block boundaries.
+	std::atomic<int> modulationInterval{1};
+
+	// Engine option: render in internal blocks of N frames (1 = off), which is faster but delays
+	// the output by N frames. Set from the UI thread, applied at block boundaries.
+	static const int maxBlockSize = 64;
+	std::atomic<int> blockSize{1};
+	int engineBlockSize = 1; // block size in use on the audio thread
+	int blockPosition = 0;
+	double blockBuffer[maxBlockSize] = {}; // last rendered block, streamed out while the next is collected
+
+	NoteEvent blockEvents[maxBlockSize]; // at most one gate edge per frame
+	int numBlockEvents = 0;
 
 	AcidEngine() {
 		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
@@ -88,57 +130,152 @@ struct AcidEngine : Module {
 		configOutput(OUT_R_OUTPUT, "Right Audio");
 
 		tb303.setSampleRate(sampleRate);
-		tb303.setVolume(0);
-		tb303.setWaveform(0.0);
-
-		// Authentic 303 settings
-		tb303.setAmpDecay(4000);
-		tb303.setAmpRelease(15);
-		tb303.setAttack(3.0f);
-		tb303.setAmpAttack(3.0f);
+		configureEngine(tb303, controlRate);
+
+		lightDivider.setDivision(256);
 	}
 
-	void process(const ProcessArgs& args) override {
-		if (sampleRate != args.sampleRate) {
-			sampleRate = args.sampleRate;
+	void setUserWaveform(const std::vector<double>& samples, const std::string& name) {
+		tb303.waveTable1.setUserWaveform(samples.empty() ? NULL : samples.data(), (int)samples.size());
+		{
+			std::lock_guard<std::mutex> lock(userWaveformMutex);
+			userWaveform.assign(samples.begin(), samples.end());
+			userWaveformName = name;
+		}
+		hasUserWaveform = !samples.empty();
+		userWaveformChanged = true;
+	}
+
+	void clearUserWaveform() {
+		setUserWaveform(std::vector<double>(), "");
+	}
+
+	bool loadUserWaveform(const std::string& path) {
+		std::vector<double> samples;
+		if (!WaveFileReader::readMono(path.c_str(), samples, maxUserWaveformLength) || samples.empty())
+			return false;
+		setUserWaveform(samples, system::getFilename(path));
+		return true;
+	}
+
+	std::string getUserWaveformName() {
+		std::lock_guard<std::mutex> lock(userWaveformMutex);
+		return userWaveformName;
+	}
+
+	// Rack calls this with the engine locked, i.e. never concurrently with process(), so the
+	// new coefficients are in place before the next sample is rendered
+	void onSampleRateChange(const SampleRateChangeEvent& e) override {
+		Module::onSampleRateChange(e);
+		if (sampleRate != e.sampleRate) {
+			sampleRate = e.sampleRate;
 			tb303.setSampleRate(sampleRate);
 		}
+	}
+
+	void onReset(const ResetEvent& e) override {
+		Module::onReset(e);
+		clearUserWaveform();
+		modulationInterval = 1;
+		blockSize = 1;
+	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		json_object_set_new(rootJ, "modulationInterval", json_integer(modulationInterval));
+		json_object_set_new(rootJ, "blockSize", json_integer(blockSize));
+		std::lock_guard<std::mutex> lock(userWaveformMutex);
+		if (!userWaveform.empty()) {
+			// Stored as base64 float32, the patch must not depend on the original file
+			json_object_set_new(rootJ, "userWaveform", json_string(string::toBase64(
+				(const uint8_t*)userWaveform.data(), userWaveform.size() * sizeof(float)).c_str()));
+			json_object_set_new(rootJ, "userWaveformLength", json_integer((json_int_t)userWaveform.size()));
+			json_object_set_new(rootJ, "userWaveformName", json_string(userWaveformName.c_str()));
+		}
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		json_t* modulationIntervalJ = json_object_get(rootJ, "modulationInterval");
+		if (modulationIntervalJ)
+			modulationInterval = clamp((int)json_integer_value(modulationIntervalJ), 1, 16);
+		json_t* blockSizeJ = json_object_get(rootJ, "blockSize");
+		if (blockSizeJ) {
+			int size = (int)json_integer_value(blockSizeJ);
+			blockSize = (size == 8 || size == 16 || size == 32 || size == 64) ? size : 1;
+		}
+
+		std::vector<double> samples;
+		std::string name;
+		json_t* waveformJ = json_object_get(rootJ, "userWaveform");
+		if (waveformJ && json_is_string(waveformJ)) {
+			// A damaged or hand-edited patch loses the waveform instead of loading garbage: the data
+			// must be whole float32 samples within the length limit, and match the stored length
+			// (which patches from before it was stored don't have)
+			std::vector<uint8_t> bytes = string::fromBase64(json_string_value(waveformJ));
+			size_t length = bytes.size() / sizeof(float);
+			json_t* lengthJ = json_object_get(rootJ, "userWaveformLength");
+			bool valid = bytes.size() % sizeof(float) == 0 && length > 0 && length <= (size_t)maxUserWaveformLength
+				&& (!lengthJ || (json_is_integer(lengthJ) && json_integer_value(lengthJ) == (json_int_t)length));
+			if (valid) {
+				samples.resize(length);
+				for (size_t i = 0; i < length; i++) {
+					float sample;
+					std::memcpy(&sample, &bytes[i * sizeof(float)], sizeof(float));
+					samples[i] = std::isfinite(sample) ? sample : 0.f;
+				}
+				json_t* nameJ = json_object_get(rootJ, "userWaveformName");
+				if (nameJ && json_is_string(nameJ))
+					name = json_string_value(nameJ);
+			}
+		}
+		if (!samples.empty() || hasUserWaveform)
+			setUserWaveform(samples, name);
+	}
+
+	void process(const ProcessArgs& args) override {
+		// Handle Gate & Note (gate input OR button)
+		bool buttonPressed = params[TRIG_BUTTON_PARAM].getValue() > 0.5f;
+		bool gateInput = (inputs[TRIG_INPUT].getVoltage() + (buttonPressed ? 10.f : 0.f)) > 2.5f;
+
+		if (sleeping) {
+			if (!gateInput) {
+				if (++controlCounter < controlRate)
+					return;
+				controlCounter = 0;
+				if (!isTouchedWhileSleeping())
+					return;
+			}
+			// Wake up with a full parameter update before the note is triggered
+			sleeping = false;
+			controlCounter = controlRate - 1;
+		}
+
+		// Decaying filter states must not fall into the slow denormal path
+		DenormalGuard denormalGuard;
+
+		// Switch the block size between blocks (starting with a block of silence)
+		if (blockPosition == 0 && blockSize != engineBlockSize) {
+			engineBlockSize = blockSize;
+			std::fill(blockBuffer, blockBuffer + maxBlockSize, 0.0);
+		}
 
-		// Control-rate parameter updates (~1.5kHz at 48kHz sample rate)
-		float slide = 0.f;
-		bool accentTriggered = false;
+		// Control-rate parameter updates (375Hz at 48kHz sample rate, ramped inside the engine)
 		if (++controlCounter >= controlRate) {
 			controlCounter = 0;
+			tb303.profiler.start();
+
+			// Block boundary: pick up wavetables rebuilt on the background thread
+			tb303.updateWaveTables();
+			if (userWaveformChanged.exchange(false))
+				tb303.waveTable1.setWaveform(hasUserWaveform ? MipMappedWaveTable::USER : MipMappedWaveTable::SAW303);
 
 			// Read mode switch - CKSSThree: top=2, bottom=0, so invert
 			// Top=Baby Fish, Middle=Momma Fish, Bottom=Devil Fish
 			int mode = 2 - (int)params[MODE_PARAM].getValue();
 
 			// Mode-dependent parameter ranges
-			float cutoffMin, cutoffMax, resMax, decayMin, decayMax, envmodMax, accentMax;
-			switch (mode) {
-				case 0: // Baby Fish - restricted ranges
-					cutoffMin = 200.f; cutoffMax = 2000.f;
-					resMax = 50.f;
-					decayMin = 200.f; decayMax = 1000.f;
-					envmodMax = 50.f;
-					accentMax = 25.f;
-					break;
-				case 2: // Devil Fish - full extended ranges
-					cutoffMin = 20.f; cutoffMax = 8000.f;
-					resMax = 100.f;
-					decayMin = 30.f; decayMax = 3000.f;
-					envmodMax = 100.f;
-					accentMax = 100.f;
-					break;
-				default: // Momma Fish - standard 303 ranges
-					cutoffMin = 100.f; cutoffMax = 4000.f;
-					resMax = 80.f;
-					decayMin = 200.f; decayMax = 2000.f;
-					envmodMax = 80.f;
-					accentMax = 50.f;
-					break;
-			}
+			ModeRanges ranges = getModeRanges(mode);
 
 			// Read parameters with CV modulation (CV is 0-10V, scaled to 0-1 range)
 			float tuning = params[TUNING_PARAM].getValue();
@@ -146,92 +283,140 @@ struct AcidEngine : Module {
 			float resonance = clamp(params[RESONANCE_PARAM].getValue() + inputs[RES_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
 			float decay = clamp(params[DECAY_PARAM].getValue() + inputs[DECAY_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
 			float envmod = clamp(params[ENVMOD_PARAM].getValue() + inputs[ENVMOD_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
-			slide = clamp(params[SLIDE_PARAM].getValue() + inputs[SLIDE_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
-			cachedSlide = slide;
 
-			// Accent: knob controls intensity, CV acts as gate trigger
+			// Accent: knob controls intensity, CV acts as gate trigger (read at the gate edge)
 			float accentAmount = params[ACCENT_PARAM].getValue();
-			accentTriggered = inputs[ACCENT_INPUT].getVoltage() > 2.5f;
-			cachedAccentTriggered = accentTriggered;
 
 			// Waveform switch - CKSSThree: top=2, bottom=0, so invert
 			// Top=Saw, Middle=Blend, Bottom=Square
 			int waveform = 2 - (int)params[WAVEFORM_PARAM].getValue();
-			tb303.setWaveform(waveform * 0.5f);
-
-			// Apply tuning (semitone offset from 440Hz)
-			float tuningHz = 440.f * std::pow(2.f, tuning / 12.f);
-			tb303.setTuning(tuningHz);
-
-			// Apply mode-scaled parameters to Open303
-			tb303.setCutoff(cutoffMin + cutoff * (cutoffMax - cutoffMin));
-			tb303.setResonance(resonance * resMax, false);
-			float decayMs = decayMin + decay * (decayMax - decayMin);
-			tb303.setDecay(decayMs);
-			tb303.setAccentDecay(decayMs * 0.2f);
-			tb303.setEnvMod(envmod * envmodMax);
-			tb303.setAccent(accentAmount * accentMax);
-		} else {
-			slide = cachedSlide;
-			accentTriggered = cachedAccentTriggered;
-		}
 
-		// Handle Gate & Note (gate input OR button)
-		bool buttonPressed = params[TRIG_BUTTON_PARAM].getValue() > 0.5f;
-		bool gateInput = (inputs[TRIG_INPUT].getVoltage() + (buttonPressed ? 10.f : 0.f)) > 2.5f;
+			// Engine values: tuning is a semitone offset from 440Hz, the rest is scaled to the mode
+			parameters.waveform = waveform * 0.5f;
+			if (tuning != lastTuning) {
+				lastTuning = tuning;
+				parameters.tuningHz = 440.f * std::pow(2.f, tuning / 12.f);
+			}
+			parameters.cutoffHz = ranges.cutoffMin + cutoff * (ranges.cutoffMax - ranges.cutoffMin);
+			parameters.resonance = resonance * ranges.resMax;
+			parameters.decayMs = ranges.decayMin + decay * (ranges.decayMax - ranges.decayMin);
+			parameters.envmod = envmod * ranges.envmodMax;
+			parameters.accent = accentAmount * ranges.accentMax;
+			parameters.modulationInterval = modulationInterval;
+			applyEngineParameters(tb303, parameters, lastParameters);
+			tb303.profiler.lap(Profiler::CONTROL);
+		}
 
 		if (gateInput && !gateHigh) {
-			// Rising edge — note on
+			// Rising edge — note on. Pitch, slide and accent are latched on exactly this sample,
+			// so a sequencer may change them together with the gate.
 			float volts = inputs[TUNING_INPUT].getVoltage();
 			int midi_note = (int)std::round(volts * 12.0f + 60.0f);
+			float slide = clamp(params[SLIDE_PARAM].getValue() + inputs[SLIDE_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
+			bool accentTriggered = inputs[ACCENT_INPUT].getVoltage() > 2.5f;
 
-			bool is_sliding = (slide > 0.05f);
-			if (is_sliding) {
-				tb303.setSlideTime(slide * 400.0f);
-			} else {
-				tb303.setSlideTime(60.0f);
-			}
+			NoteEvent event;
+			event.portamento = (slide > 0.05f);
+			event.slideTime = event.portamento ? slide * 400.0f : 60.0f;
 
 			// Velocity < 100 = no accent, >= 100 = accent triggered
-			int velocity = accentTriggered ? 127 : 80;
+			event.velocity = accentTriggered ? 127 : 80;
 
 			active_note = midi_note;
-
-			if (!is_sliding) {
-				tb303.allNotesOff();
-				tb303.noteOn(active_note, velocity);
-			} else {
-				tb303.trimNoteList();
-				tb303.noteOnPortamento(active_note, velocity);
-			}
+			event.note = active_note;
+			queueNoteEvent(event);
 		}
 
 		if (!gateInput && gateHigh) {
 			// Falling edge — note off (velocity 0 triggers noteOff in Open303)
-			tb303.noteOn(active_note, 0);
+			NoteEvent event = {0, active_note, 0, 0.f, false};
+			queueNoteEvent(event);
 		}
 
 		gateHigh = gateInput;
 
-		float out = (float)tb303.getSample() * 5.0f;
+		float out;
+		if (engineBlockSize == 1) {
+			out = (float)tb303.getSample() * 5.0f;
+		} else {
+			out = (float)blockBuffer[blockPosition] * 5.0f;
+			if (++blockPosition == engineBlockSize) {
+				renderBlock();
+				blockPosition = 0;
+			}
+		}
 		outputs[OUT_L_OUTPUT].setVoltage(out);
 		outputs[OUT_R_OUTPUT].setVoltage(out);
 
-		// VU meter - track peak level with decay
-		float absOut = std::fabs(out) / 5.0f; // Normalize to 0-1 range
-		if (absOut > vuLevel) {
-			vuLevel = absOut; // Attack - instant
-		} else {
-			vuLevel -= 0.0001f; // Decay - slow falloff
-			if (vuLevel < 0.f) vuLevel = 0.f;
+		// VU meter - track the peak of the block, normalized to 0-1 range
+		vuPeak = std::max(vuPeak, std::fabs(out) / 5.0f);
+
+		if (lightDivider.process()) {
+			// Attack - instant, decay - slow falloff at a fixed rate in time
+			float lightTime = args.sampleTime * lightDivider.getDivision();
+			vuLevel = std::max(vuPeak, vuLevel - vuDecayPerSecond * lightTime);
+			vuPeak = 0.f;
+
+			// Set VU lights based on level thresholds
+			lights[VU_LIGHT_1].setBrightness(vuLevel > 0.1f ? 1.f : vuLevel * 10.f);
+			lights[VU_LIGHT_2].setBrightness(vuLevel > 0.4f ? 1.f : (vuLevel > 0.1f ? (vuLevel - 0.1f) * 3.33f : 0.f));
+			lights[VU_LIGHT_3].setBrightness(vuLevel > 0.7f ? 1.f : (vuLevel > 0.4f ? (vuLevel - 0.4f) * 3.33f : 0.f));
+
+			// Go to sleep once the voice is silent and the meter has fallen back (outputs and
+			// lights are at zero then and stay there)
+			if (!gateInput && vuLevel == 0.f && tb303.isIdle() && numBlockEvents == 0) {
+				sleeping = true;
+				for (int i = 0; i < PARAMS_LEN; i++)
+					sleepParams[i] = params[i].getValue();
+			}
 		}
+	}
 
-		// Set VU lights based on level thresholds
-		lights[VU_LIGHT_1].setBrightness(vuLevel > 0.1f ? 1.f : vuLevel * 10.f);
-		lights[VU_LIGHT_2].setBrightness(vuLevel > 0.4f ? 1.f : (vuLevel > 0.1f ? (vuLevel - 0.1f) * 3.33f : 0.f));
-		lights[VU_LIGHT_3].setBrightness(vuLevel > 0.7f ? 1.f : (vuLevel > 0.4f ? (vuLevel - 0.4f) * 3.33f : 0.f));
+	void queueNoteEvent(NoteEvent event) {
+		if (engineBlockSize == 1) {
+			applyNoteEvent(tb303, event);
+			return;
+		}
+		event.frame = blockPosition;
+		blockEvents[numBlockEvents++] = event;
+	}
+
+	// Renders the collected block, split at the frames of its note events
+	void renderBlock() {
+		int frame = 0;
+		for (int i = 0; i < numBlockEvents; i++) {
+			tb303.processBlock(blockBuffer + frame, blockEvents[i].frame - frame);
+			frame = blockEvents[i].frame;
+			applyNoteEvent(tb303, blockEvents[i]);
+		}
+		tb303.processBlock(blockBuffer + frame, engineBlockSize - frame);
+		numBlockEvents = 0;
+	}
+
+	// Returns true when a parameter or an engine option has changed since going to sleep
+	bool isTouchedWhileSleeping() {
+		if (userWaveformChanged || tb303.getModulationInterval() != modulationInterval)
+			return true;
+		for (int i = 0; i < PARAMS_LEN; i++) {
+			if (params[i].getValue() != sleepParams[i])
+				return true;
+		}
+		return false;
+	}
+};
+
+#ifdef ROSIC_PROFILE
+// Menu line that follows a measurement of the engine profiler while the menu is open
+struct ProfilerLabel : MenuLabel {
+	AcidEngine* module;
+	std::function<std::string(const Profiler&)> format;
+
+	void step() override {
+		text = format(module->tb303.profiler);
+		MenuLabel::step();
 	}
 };
+#endif
 
 struct AcidEngineWidget : ModuleWidget {
 	AcidEngineWidget(AcidEngine* module) {
@@ -285,6 +470,98 @@ struct AcidEngineWidget : ModuleWidget {
 		addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(37.582, 116.315)), module, AcidEngine::OUT_L_OUTPUT));
 		addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(51.902, 116.315)), module, AcidEngine::OUT_R_OUTPUT));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		AcidEngine* module = getModule<AcidEngine>();
+		if (!module)
+			return;
+
+		menu->addChild(new MenuSeparator);
+		menu->addChild(createMenuLabel("User waveform (replaces Saw)"));
+		menu->addChild(createMenuItem("Load single-cycle WAV...", "", [=]() {
+			osdialog_filters* filters = osdialog_filters_parse("WAV:wav");
+			char* path = osdialog_file(OSDIALOG_OPEN, NULL, NULL, filters);
+			osdialog_filters_free(filters);
+			if (!path)
+				return;
+			if (!module->loadUserWaveform(path))
+				osdialog_message(OSDIALOG_WARNING, OSDIALOG_OK, "Could not read the WAV file.");
+			std::free(path);
+		}));
+		if (module->hasUserWaveform) {
+			menu->addChild(createMenuItem("Clear user waveform", module->getUserWaveformName(), [=]() {
+				module->clearUserWaveform();
+			}));
+		}
+
+		menu->addChild(new MenuSeparator);
+		menu->addChild(createIndexSubmenuItem("Modulation rate",
+			{"Every sample", "Every 2 samples", "Every 4 samples", "Every 8 samples", "Every 16 samples"},
+			[=]() {
+				size_t index = 0;
+				for (int interval = module->modulationInterval; interval > 1; interval >>= 1)
+					index++;
+				return index;
+			},
+			[=](size_t index) {
+				module->modulationInterval = 1 << index;
+			}
+		));
+
+		// Labels show the added latency at the current sample rate
+		static const int blockSizes[] = {1, 8, 16, 32, 64};
+		std::vector<std::string> blockLabels = {"Off"};
+		for (int i = 1; i < 5; i++)
+			blockLabels.push_back(string::f("%d frames (%.2f ms latency)", blockSizes[i], 1000.f * blockSizes[i] / module->sampleRate));
+		menu->addChild(createIndexSubmenuItem("Processing blocks", blockLabels,
+			[=]() {
+				size_t index = 0;
+				while (index < 4 && blockSizes[index] != module->blockSize)
+					index++;
+				return index;
+			},
+			[=](size_t index) {
+				module->blockSize = blockSizes[index];
+			}
+		));
+
+#ifdef ROSIC_PROFILE
+		// Built with PROFILE=1: moving averages of the engine stages (in the order of processing)
+		// and of the control block, per sample that the engine was asked for
+		menu->addChild(new MenuSeparator);
+		menu->addChild(createMenuLabel("CPU per sample"));
+		static const char* stageNames[Profiler::NUM_STAGES] = {"Modulation", "Filter coefficients", "Oscillator (4x)", "Filter (4x)", "Post filters", "Control block"};
+		for (int i = 0; i < Profiler::NUM_STAGES; i++) {
+			ProfilerLabel* label = new ProfilerLabel;
+			label->module = module;
+			label->format = [=](const Profiler& profiler) {
+				return string::f("%s: %.1f ns", stageNames[i], profiler.getNanosecondsPerSample(i));
+			};
+			menu->addChild(label);
+		}
+		ProfilerLabel* total = new ProfilerLabel;
+		total->module = module;
+		total->format = [](const Profiler& profiler) {
+			double sum = 0.0;
+			for (int i = 0; i < Profiler::NUM_STAGES; i++)
+				sum += profiler.getNanosecondsPerSample(i);
+			return string::f("Total: %.1f ns", sum);
+		};
+		menu->addChild(total);
+		ProfilerLabel* coefficients = new ProfilerLabel;
+		coefficients->module = module;
+		coefficients->format = [](const Profiler& profiler) {
+			return string::f("Coefficient updates: %.0f/s", profiler.getCountPerSecond(Profiler::COEFFICIENT_UPDATES));
+		};
+		menu->addChild(coefficients);
+		ProfilerLabel* rebuilds = new ProfilerLabel;
+		rebuilds->module = module;
+		rebuilds->format = [](const Profiler& profiler) {
+			return string::f("Wavetable rebuilds: %lld", profiler.getTotalCount(Profiler::WAVETABLE_REBUILDS));
+		};
+		menu->addChild(rebuilds);
+#endif
+	}
 };
 
 // Define the Model object (this is referenced in plugin.cpp)
@@ -0,0 +1,81 @@
+#pragma once
+#include "open303/rosic_Open303.h"
+#include <cmath>
+
+// Shared by the Acid Engine modules: the engine values that a module sets, its note events and
+// the setup of the parts of the engine that the panel doesn't control.
+
+// Engine settings in engine units, computed by the module at control rate
+struct EngineParameters {
+	float waveform = INFINITY;    // 0 = saw, 0.5 = blend, 1 = square
+	float tuningHz = INFINITY;    // A4
+	float cutoffHz = INFINITY;
+	float resonance = INFINITY;   // percent
+	float decayMs = INFINITY;     // accented notes decay 5x faster
+	float envmod = INFINITY;      // percent
+	float accent = INFINITY;      // percent
+	int modulationInterval = -1;
+};
+
+// A note event from the gate, applied at its frame in the block when rendered in blocks
+struct NoteEvent {
+	int frame;
+	int note;
+	int velocity; // 0 = note off
+	float slideTime;
+	bool portamento;
+};
+
+// Sets up the parts of the engine that the panel doesn't control
+inline void configureEngine(rosic::Open303& engine, int parameterSmoothing) {
+	engine.setVolume(0);
+	engine.setWaveform(0.0);
+
+	// Authentic 303 settings
+	engine.setAmpDecay(4000);
+	engine.setAmpRelease(15);
+	engine.setAttack(3.0f);
+	engine.setAmpAttack(3.0f);
+
+	// Cutoff, resonance and envmod glide over one control block inside the engine
+	engine.setParameterSmoothing(parameterSmoothing);
+}
+
+// Pushes the values that differ from the last pushed ones into the engine, so that unchanged
+// knobs and CVs skip the setters (and the recalculations these trigger in Open303)
+inline void applyEngineParameters(rosic::Open303& engine, const EngineParameters& p, EngineParameters& last) {
+	if (p.waveform != last.waveform)
+		engine.setWaveform(p.waveform);
+	if (p.tuningHz != last.tuningHz)
+		engine.setTuning(p.tuningHz);
+	if (p.cutoffHz != last.cutoffHz)
+		engine.setCutoff(p.cutoffHz);
+	if (p.resonance != last.resonance)
+		engine.setResonance(p.resonance, false);
+	if (p.decayMs != last.decayMs) {
+		engine.setDecay(p.decayMs);
+		engine.setAccentDecay(p.decayMs * 0.2f);
+	}
+	if (p.envmod != last.envmod)
+		engine.setEnvMod(p.envmod);
+	if (p.accent != last.accent)
+		engine.setAccent(p.accent);
+	if (p.modulationInterval != last.modulationInterval)
+		engine.setModulationInterval(p.modulationInterval);
+	last = p;
+}
+
+inline void applyNoteEvent(rosic::Open303& engine, const NoteEvent& event) {
+	if (event.velocity == 0) {
+		engine.noteOn(event.note, 0);
+		return;
+	}
+	engine.setSlideTime(event.slideTime);
+	if (!event.portamento) {
+		engine.allNotesOff();
+		engine.noteOn(event.note, event.velocity);
+	} else {
+		engine.trimNoteList();
+		engine.noteOnPortamento(event.note, event.velocity);
+	}
+}
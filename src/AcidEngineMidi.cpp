@@ -0,0 +1,319 @@
+#include "plugin.hpp"
+#include "AcidModes.hpp"
+#include "AcidEngineCommon.hpp"
+#include "open303/rosic_Open303.h"
+#include "open303/rosic_DenormalGuard.h"
+
+using namespace rosic;
+
+// Acid Engine played over MIDI. Notes, pitch bend and CCs go straight into Open303 on the frame
+// they are timestamped with, so there is no CV thresholding or control-rate quantization in
+// between. Open303 speaks MIDI itself: velocity >= 100 is an accent and a note that arrives
+// while another one is held slides to the new pitch (legato).
+struct AcidEngineMidi : Module {
+	enum ParamId {
+		TUNING_PARAM,
+		CUTOFF_PARAM,
+		RESONANCE_PARAM,
+		DECAY_PARAM,
+		ENVMOD_PARAM,
+		SLIDE_PARAM,
+		ACCENT_PARAM,
+		WAVEFORM_PARAM,
+		MODE_PARAM,
+		TRIG_BUTTON_PARAM,
+		PARAMS_LEN
+	};
+	enum InputId {
+		INPUTS_LEN
+	};
+	enum OutputId {
+		OUT_L_OUTPUT,
+		OUT_R_OUTPUT,
+		OUTPUTS_LEN
+	};
+	enum LightId {
+		VU_LIGHT_1,
+		VU_LIGHT_2,
+		VU_LIGHT_3,
+		LIGHTS_LEN
+	};
+
+	// Continuous controllers, as on the Roland TB-03 (plus portamento time for the slide)
+	enum ControllerNumber {
+		CC_PORTAMENTO_TIME = 5,
+		CC_ENVMOD = 12,
+		CC_ACCENT = 16,
+		CC_RESONANCE = 71,
+		CC_CUTOFF = 74,
+		CC_DECAY = 75,
+		CC_TUNING = 104,
+		CC_ALL_SOUND_OFF = 120,
+		CC_ALL_NOTES_OFF = 123
+	};
+
+	static constexpr float pitchBendRange = 2.f; // semitones
+
+	midi::InputQueue midiInput;
+	Open303 tb303;
+
+	float sampleRate = 44100.f;
+	int buttonNote = 60; // played by the trigger button: the last MIDI note
+	bool buttonHigh = false;
+
+	int controlCounter = controlRate - 1; // the first frame pushes the knobs
+	static const int controlRate = 128;
+
+	// Engine values computed from the knobs, and the ones last pushed into the engine
+	EngineParameters parameters;
+	EngineParameters lastParameters;
+	float lastTuning = INFINITY; // knob value that parameters.tuningHz was computed from
+	// Slide time last pushed - not part of EngineParameters, as Acid Engine sends it with the notes
+	float lastSlide = INFINITY;
+
+	// VU meter: the peak is collected per sample, the level and lights follow at UI rate
+	float vuPeak = 0.f;
+	float vuLevel = 0.f;
+	static constexpr float vuDecayPerSecond = 4.41f; // full scale to zero in ~230ms
+	dsp::ClockDivider lightDivider;
+
+	AcidEngineMidi() {
+		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
+
+		// Knobs
+		configParam(TUNING_PARAM, -12.f, 12.f, 0.f, "Tuning", " semitones");
+		configParam(CUTOFF_PARAM, 0.f, 1.f, 0.5f, "Cutoff Frequency");
+		configParam(RESONANCE_PARAM, 0.f, 1.f, 0.5f, "Resonance");
+		configParam(DECAY_PARAM, 0.f, 1.f, 0.5f, "Decay");
+		configParam(ENVMOD_PARAM, 0.f, 1.f, 0.5f, "Envelope Mod");
+		configParam(SLIDE_PARAM, 0.f, 1.f, 0.0f, "Slide Time");
+		configParam(ACCENT_PARAM, 0.f, 1.f, 0.0f, "Accent");
+
+		// Switches
+		configSwitch(WAVEFORM_PARAM, 0.f, 2.f, 0.f, "Waveform", {"Saw", "Blend", "Square"});
+		configSwitch(MODE_PARAM, 0.f, 2.f, 1.f, "Parameter Mode", {"Baby Fish", "Momma Fish", "Devil Fish"});
+
+		// Trigger button
+		configButton(TRIG_BUTTON_PARAM, "Trigger");
+
+		// Outputs
+		configOutput(OUT_L_OUTPUT, "Left Audio");
+		configOutput(OUT_R_OUTPUT, "Right Audio");
+
+		// Knob changes glide over one control block inside the engine (CCs are applied on their
+		// frame and glide just the same)
+		tb303.setSampleRate(sampleRate);
+		configureEngine(tb303, controlRate);
+
+		lightDivider.setDivision(256);
+	}
+
+	void onSampleRateChange(const SampleRateChangeEvent& e) override {
+		Module::onSampleRateChange(e);
+		if (sampleRate != e.sampleRate) {
+			sampleRate = e.sampleRate;
+			tb303.setSampleRate(sampleRate);
+		}
+	}
+
+	void onReset(const ResetEvent& e) override {
+		Module::onReset(e);
+		midiInput.reset();
+		tb303.allNotesOff();
+		tb303.setPitchBend(0.0);
+	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		json_object_set_new(rootJ, "midi", midiInput.toJson());
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		json_t* midiJ = json_object_get(rootJ, "midi");
+		if (midiJ)
+			midiInput.fromJson(midiJ);
+	}
+
+	void process(const ProcessArgs& args) override {
+		// Decaying filter states must not fall into the slow denormal path
+		DenormalGuard denormalGuard;
+
+		// Control-rate knob updates (375Hz at 48kHz sample rate, ramped inside the engine)
+		if (++controlCounter >= controlRate) {
+			controlCounter = 0;
+			tb303.updateWaveTables();
+			pushParameters();
+		}
+
+		// MIDI messages that are due on this frame
+		midi::Message msg;
+		while (midiInput.tryPop(&msg, args.frame))
+			processMessage(msg);
+
+		// The trigger button plays the last note, like a gate on Acid Engine
+		bool buttonPressed = params[TRIG_BUTTON_PARAM].getValue() > 0.5f;
+		if (buttonPressed != buttonHigh) {
+			buttonHigh = buttonPressed;
+			NoteEvent event;
+			event.frame = 0;
+			event.note = buttonNote;
+			event.velocity = buttonPressed ? 80 : 0;
+			event.slideTime = getSlideTime();
+			event.portamento = false;
+			applyNoteEvent(tb303, event);
+		}
+
+		float out = (float)tb303.getSample() * 5.0f;
+		outputs[OUT_L_OUTPUT].setVoltage(out);
+		outputs[OUT_R_OUTPUT].setVoltage(out);
+
+		// VU meter - track the peak of the block, normalized to 0-1 range
+		vuPeak = std::max(vuPeak, std::fabs(out) / 5.0f);
+
+		if (lightDivider.process()) {
+			// Attack - instant, decay - slow falloff at a fixed rate in time
+			float lightTime = args.sampleTime * lightDivider.getDivision();
+			vuLevel = std::max(vuPeak, vuLevel - vuDecayPerSecond * lightTime);
+			vuPeak = 0.f;
+
+			// Set VU lights based on level thresholds
+			lights[VU_LIGHT_1].setBrightness(vuLevel > 0.1f ? 1.f : vuLevel * 10.f);
+			lights[VU_LIGHT_2].setBrightness(vuLevel > 0.4f ? 1.f : (vuLevel > 0.1f ? (vuLevel - 0.1f) * 3.33f : 0.f));
+			lights[VU_LIGHT_3].setBrightness(vuLevel > 0.7f ? 1.f : (vuLevel > 0.4f ? (vuLevel - 0.4f) * 3.33f : 0.f));
+		}
+	}
+
+	void processMessage(const midi::Message& msg) {
+		switch (msg.getStatus()) {
+			case 0x8: // note off
+				tb303.noteOn(msg.getNote(), 0);
+				break;
+			case 0x9: // note on (velocity 0 is a note off, Open303 handles both)
+				tb303.noteOn(msg.getNote(), msg.getValue());
+				if (msg.getValue() > 0)
+					buttonNote = msg.getNote();
+				break;
+			case 0xe: { // pitch bend, 14 bit around 8192
+				int bend = ((int)msg.bytes[2] << 7 | msg.bytes[1]) - 8192;
+				tb303.setPitchBend(pitchBendRange * bend / 8192.f);
+			} break;
+			case 0xb: // control change
+				processControlChange(msg.getNote(), msg.getValue());
+				break;
+			default:
+				break;
+		}
+	}
+
+	// Moves the mapped knob and pushes it into the engine right away, so the change starts on
+	// the frame of the message
+	void processControlChange(int controller, int value) {
+		int paramId;
+		switch (controller) {
+			case CC_PORTAMENTO_TIME: paramId = SLIDE_PARAM; break;
+			case CC_ENVMOD: paramId = ENVMOD_PARAM; break;
+			case CC_ACCENT: paramId = ACCENT_PARAM; break;
+			case CC_RESONANCE: paramId = RESONANCE_PARAM; break;
+			case CC_CUTOFF: paramId = CUTOFF_PARAM; break;
+			case CC_DECAY: paramId = DECAY_PARAM; break;
+			case CC_TUNING: paramId = TUNING_PARAM; break;
+			case CC_ALL_SOUND_OFF:
+			case CC_ALL_NOTES_OFF:
+				tb303.allNotesOff();
+				return;
+			default:
+				return;
+		}
+		ParamQuantity* pq = paramQuantities[paramId];
+		if (paramId == TUNING_PARAM) {
+			// Around the center, such that 64 is exactly in tune and 0 and 127 reach the ends
+			float center = 0.5f * (pq->minValue + pq->maxValue);
+			float x = value < 64 ? (value - 64) / 64.f : (value - 64) / 63.f;
+			params[paramId].setValue(center + x * (pq->maxValue - center));
+		} else {
+			params[paramId].setValue(pq->minValue + (pq->maxValue - pq->minValue) * value / 127.f);
+		}
+		pushParameters();
+	}
+
+	// Slide time for legato notes, from the 303's 60 ms up to 400 ms
+	float getSlideTime() {
+		return 60.f + params[SLIDE_PARAM].getValue() * 340.f;
+	}
+
+	// Pushes the knobs that have changed since the last call into the engine
+	void pushParameters() {
+		// Read mode switch - CKSSThree: top=2, bottom=0, so invert
+		// Top=Baby Fish, Middle=Momma Fish, Bottom=Devil Fish
+		int mode = 2 - (int)params[MODE_PARAM].getValue();
+		ModeRanges ranges = getModeRanges(mode);
+
+		// Waveform switch - CKSSThree: top=2, bottom=0, so invert
+		// Top=Saw, Middle=Blend, Bottom=Square
+		int waveform = 2 - (int)params[WAVEFORM_PARAM].getValue();
+
+		// Engine values: tuning is a semitone offset from 440Hz, the rest is scaled to the mode
+		float tuning = params[TUNING_PARAM].getValue();
+		if (tuning != lastTuning) {
+			lastTuning = tuning;
+			parameters.tuningHz = 440.f * std::pow(2.f, tuning / 12.f);
+		}
+		parameters.waveform = waveform * 0.5f;
+		parameters.cutoffHz = ranges.cutoffMin + params[CUTOFF_PARAM].getValue() * (ranges.cutoffMax - ranges.cutoffMin);
+		parameters.resonance = params[RESONANCE_PARAM].getValue() * ranges.resMax;
+		parameters.decayMs = ranges.decayMin + params[DECAY_PARAM].getValue() * (ranges.decayMax - ranges.decayMin);
+		parameters.envmod = params[ENVMOD_PARAM].getValue() * ranges.envmodMax;
+		parameters.accent = params[ACCENT_PARAM].getValue() * ranges.accentMax;
+		parameters.modulationInterval = 1; // full rate, there is no menu option for it here
+		applyEngineParameters(tb303, parameters, lastParameters);
+
+		float slide = params[SLIDE_PARAM].getValue();
+		if (slide != lastSlide) {
+			lastSlide = slide;
+			tb303.setSlideTime(getSlideTime());
+		}
+	}
+};
+
+struct AcidEngineMidiWidget : ModuleWidget {
+	AcidEngineMidiWidget(AcidEngineMidi* module) {
+		setModule(module);
+		setPanel(createPanel(asset::plugin(pluginInstance, "res/AcidEngineMidi.svg")));
+
+		// Screws
+		addChild(createWidget<ScrewSilver>(Vec(RACK_GRID_WIDTH, 0)));
+		addChild(createWidget<ScrewSilver>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, 0)));
+		addChild(createWidget<ScrewSilver>(Vec(RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
+		addChild(createWidget<ScrewSilver>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
+
+		// VU meter lights
+		addChild(createLightCentered<MediumLight<YellowLight>>(mm2px(Vec(24.0, 11.5)), module, AcidEngineMidi::VU_LIGHT_1));
+		addChild(createLightCentered<MediumLight<YellowLight>>(mm2px(Vec(30.48, 11.5)), module, AcidEngineMidi::VU_LIGHT_2));
+		addChild(createLightCentered<MediumLight<YellowLight>>(mm2px(Vec(36.96, 11.5)), module, AcidEngineMidi::VU_LIGHT_3));
+
+		// Knobs and switches in the same places as on Acid Engine
+		addParam(createParamCentered<Rogan1PWhite>(mm2px(Vec(12.0, 27.0)), module, AcidEngineMidi::TUNING_PARAM));
+		addParam(createParamCentered<Rogan1PWhite>(mm2px(Vec(48.96, 27.0)), module, AcidEngineMidi::RESONANCE_PARAM));
+		addParam(createParamCentered<Rogan3PSWhite>(mm2px(Vec(30.48, 35.0)), module, AcidEngineMidi::CUTOFF_PARAM));
+		addParam(createParamCentered<Rogan1PSWhite>(mm2px(Vec(12.0, 45.5)), module, AcidEngineMidi::DECAY_PARAM));
+		addParam(createParamCentered<Rogan1PSWhite>(mm2px(Vec(48.96, 45.5)), module, AcidEngineMidi::ENVMOD_PARAM));
+		addParam(createParamCentered<CKSSThree>(mm2px(Vec(12.0, 62.0)), module, AcidEngineMidi::WAVEFORM_PARAM));
+		addParam(createParamCentered<Rogan1PWhite>(mm2px(Vec(30.48, 59.0)), module, AcidEngineMidi::SLIDE_PARAM));
+		addParam(createParamCentered<CKSSThree>(mm2px(Vec(12.0, 76.0)), module, AcidEngineMidi::MODE_PARAM));
+		addParam(createParamCentered<Rogan1PWhite>(mm2px(Vec(30.48, 76.0)), module, AcidEngineMidi::ACCENT_PARAM));
+		addParam(createParamCentered<VCVButton>(mm2px(Vec(48.96, 76.0)), module, AcidEngineMidi::TRIG_BUTTON_PARAM));
+
+		// MIDI driver, device and channel in the band of the CV inputs
+		MidiDisplay* midiDisplay = createWidget<MidiDisplay>(mm2px(Vec(4.0, 85.5)));
+		midiDisplay->box.size = mm2px(Vec(52.96, 22.5));
+		midiDisplay->setMidiPort(module ? &module->midiInput : NULL);
+		addChild(midiDisplay);
+
+		// Outputs: OUT L, OUT R
+		addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(37.582, 116.315)), module, AcidEngineMidi::OUT_L_OUTPUT));
+		addOutput(createOutputCentered<PJ301MPort>(mm2px(Vec(51.902, 116.315)), module, AcidEngineMidi::OUT_R_OUTPUT));
+	}
+};
+
+Model* modelAcidEngineMidi = createModel<AcidEngineMidi, AcidEngineMidiWidget>("AcidEngineMidi");
@@ -0,0 +1,22 @@
+#pragma once
+
+// Parameter ranges of the three modes, shared by the CV and the MIDI module.
+// Mode index: 0 = Baby Fish, 1 = Momma Fish, 2 = Devil Fish
+struct ModeRanges {
+	float cutoffMin, cutoffMax;
+	float resMax;
+	float decayMin, decayMax;
+	float envmodMax;
+	float accentMax;
+};
+
+inline ModeRanges getModeRanges(int mode) {
+	switch (mode) {
+		case 0: // Baby Fish - restricted ranges
+			return {200.f, 2000.f, 50.f, 200.f, 1000.f, 50.f, 25.f};
+		case 2: // Devil Fish - full extended ranges
+			return {20.f, 8000.f, 100.f, 30.f, 3000.f, 100.f, 100.f};
+		default: // Momma Fish - standard 303 ranges
+			return {100.f, 4000.f, 80.f, 200.f, 2000.f, 80.f, 50.f};
+	}
+}
@@ -12,8 +12,6 @@ rosic namespace to facilitate their global use. */
 #define INLINE inline  // something better to do here ?
 #endif
 
-//_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON)
-
 //-------------------------------------------------------------------------------------------------
 // mathematical constants:
 
@@ -55,6 +53,15 @@ typedef unsigned long UINT32;
 #define TINY FLT_MIN
 #define EPS DBL_EPSILON
 
+// the recursive filters add TINY to their outputs to keep their states out of the denormal range.
+// when the engine runs under a DenormalGuard (see rosic_DenormalGuard.h), these additions can be 
+// compiled out by defining ROSIC_NO_DENORMAL_OFFSETS:
+#ifdef ROSIC_NO_DENORMAL_OFFSETS
+#define ANTI_DENORMAL(x) (x)
+#else
+#define ANTI_DENORMAL(x) ((x) + TINY)
+#endif
+
 // define infinity values:
 
 inline double dummyFunction(double x) { return x; }
@@ -15,7 +15,6 @@ AnalogEnvelope::AnalogEnvelope()
   sustainLevel   = 0.5;
   releaseTime    = 0.01;
   endLevel       = 0.0;
-  time           = 0.0;
   timeScale      = 1.0;
   peakByVel      = 1.0;
   peakByKey      = 1.0;
@@ -28,11 +27,21 @@ AnalogEnvelope::AnalogEnvelope()
   outputIsZero   = true;
 
   previousOutput = 0.0;
+  segment        = DONE;
+  samplesLeft    = INT_MAX;
+  segmentEnd     = 0;
+  coeff          = 1.0;
+  releaseLogDecay     = 0.0;
+  samplesLeftLogDecay = 0.0;
+  target         = endLevel;
 
   // call these functions to trigger the coefficient calculations:
   setAttack(attackTime);
   setDecay(decayTime);
   setRelease(releaseTime);
+
+  // like the time variable of old, the envelope starts in the attack segment:
+  reset();
 }
 
 AnalogEnvelope::~AnalogEnvelope()
@@ -109,6 +118,7 @@ void AnalogEnvelope::setRelease(double newReleaseTime)
     releaseTime  = 0.0;
     releaseCoeff = 1.0;
   }
+  releaseLogDecay = releaseCoeff < 1.0 ? log(1.0 - releaseCoeff) : 0.0;
   calculateAccumulatedTimes();
 }
 
@@ -139,6 +149,41 @@ void AnalogEnvelope::setPeakScale(double newPeakScale)
 {
   if( newPeakScale > 0 )
     peakScale = newPeakScale;
+  loadSegment(false);
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void AnalogEnvelope::renderBlock(double* buffer, int numSamples)
+{
+  int n = 0;
+  while( n < numSamples )
+  {
+    if( samplesLeft == 0 )
+      enterNextSegment();
+
+    // run the closed-form solution up to the end of the segment or block - only the distance to 
+    // the target is carried from one vector to the next:
+    int     numInSegment = rmin(numSamples-n, samplesLeft);
+    double* out          = buffer + n;
+    double  distance     = previousOutput - target;
+    int     i, j;
+    for(i=0; i+vectorSize<=numInSegment; i+=vectorSize)
+    {
+      for(j=0; j<vectorSize; j++)
+        out[i+j] = target + distance*powers[j];
+      distance *= powers[vectorSize-1];
+    }
+    for(j=0; i+j<numInSegment; j++)
+      out[i+j] = target + distance*powers[j];
+    if( j > 0 )
+      distance *= powers[j-1];
+
+    previousOutput  = target + distance;
+    samplesLeft    -= numInSegment;
+    n              += numInSegment;
+  }
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -146,7 +191,8 @@ void AnalogEnvelope::setPeakScale(double newPeakScale)
 
 void AnalogEnvelope::reset()
 {
-  time = 0.0;
+  segmentEnd = 0;
+  enterSegment(ATTACK);
 }
 
 void AnalogEnvelope::noteOn(bool startFromCurrentLevel)
@@ -158,18 +204,18 @@ void AnalogEnvelope::noteOn(bool startFromCurrentLevel)
   // \todo: calculate key and velocity scale factors for duration and peak-value...
 
 
-  // reset time for the new note:
-  time         = 0.0;
+  // start the new note from the attack:
   noteIsOn     = true;
   outputIsZero = false;
+  reset();
 }
 
 void AnalogEnvelope::noteOff()
 {
   noteIsOn = false;
 
-  // advance time to the beginnig of the release phase:
-  time = (attackTime + holdTime + decayTime + increment);
+  // skip to the release segment:
+  enterSegment(RELEASE);
 }
 
 bool AnalogEnvelope::endIsReached()
@@ -190,4 +236,121 @@ void AnalogEnvelope::calculateAccumulatedTimes()
   attPlusHld               = attackTime + holdTime;
   attPlusHldPlusDec        = attPlusHld + decayTime;
   attPlusHldPlusDecPlusRel = attPlusHldPlusDec + releaseTime;
+
+  // the boundaries in samples - the segments are shortened or lengthened, as if the time had 
+  // been counted with the new values from note-on on:
+  int position = segmentEnd - samplesLeft;
+  attackEnd    = getNumSamplesUpTo(attackTime);
+  holdEnd      = getNumSamplesUpTo(attPlusHld);
+  decayEnd     = getNumSamplesUpTo(attPlusHldPlusDec);
+  if( segment <= DECAY )
+  {
+    segmentEnd = position;
+    enterSegment(segment);
+  }
+  else
+    loadSegment(false); // the coefficients may have changed
+}
+
+int AnalogEnvelope::getNumSamplesUpTo(double timeInMilliseconds) const
+{
+  // the sample at note-on always belongs to the attack, so this is at least 1:
+  return (int) clip(floor(timeInMilliseconds/increment) + 1.0, 1.0, (double) (INT_MAX/2));
+}
+
+int AnalogEnvelope::getSegmentEnd(int segmentIndex) const
+{
+  switch( segmentIndex )
+  {
+  case ATTACK: return attackEnd;
+  case HOLD:   return holdEnd;
+  case DECAY:  return decayEnd;
+  default:     return INT_MAX;
+  }
+}
+
+void AnalogEnvelope::enterSegment(int newSegment)
+{
+  // skip the timed segments that have already ended (segmentEnd is the current position here):
+  segment = newSegment;
+  while( segment <= DECAY && getSegmentEnd(segment) <= segmentEnd )
+    segment++;
+  if( segment == SUSTAIN && !noteIsOn )
+    segment = RELEASE;
+
+  if( segment <= DECAY )
+  {
+    samplesLeft = getSegmentEnd(segment) - segmentEnd;
+    segmentEnd  = getSegmentEnd(segment);
+  }
+  else
+    samplesLeft = INT_MAX; // sustain and done last until the next note event
+
+  loadSegment(true);
+}
+
+void AnalogEnvelope::enterNextSegment()
+{
+  if( segment == SUSTAIN || segment == DONE )
+    enterSegment(segment);   // just reloads the counter
+  else
+    enterSegment(segment+1);
+}
+
+void AnalogEnvelope::loadSegment(bool distanceChanged)
+{
+  // hold continues the attack filter and sustain the decay filter:
+  switch( segment )
+  {
+  case ATTACK:
+  case HOLD:
+    {
+      coeff  = attackCoeff;
+      target = peakScale*peakLevel;
+    }
+    break;
+  case DECAY:
+  case SUSTAIN:
+    {
+      coeff  = decayCoeff;
+      target = sustainLevel;
+    }
+    break;
+  case RELEASE:
+    {
+      coeff  = releaseCoeff;
+      target = endLevel;
+
+      // the release ends, when the distance to the end level has decayed below -180 dB:
+      if( distanceChanged )
+      {
+        double distance = fabs(previousOutput - endLevel);
+        samplesLeft     = 1;
+        if( distance > 1.e-9 && releaseLogDecay < 0.0 )
+          samplesLeft = (int) clip(ceil(log(1.e-9/distance) / releaseLogDecay), 1.0, 
+                                   (double) INT_MAX);
+      }
+      else if( releaseLogDecay != samplesLeftLogDecay )
+      {
+        // a new release time stretches the rest of the release (the logarithm of the remaining
+        // distance is samplesLeft times the old log-decay, so no logarithm is needed here):
+        double remaining = samplesLeft * samplesLeftLogDecay;
+        samplesLeft      = 1;
+        if( releaseLogDecay < 0.0 )
+          samplesLeft = (int) clip(ceil(remaining / releaseLogDecay), 1.0, (double) INT_MAX);
+      }
+      samplesLeftLogDecay = releaseLogDecay;
+    }
+    break;
+  default:
+    {
+      // done - snap to the end level and stay there:
+      coeff  = 1.0;
+      target = endLevel;
+    }
+  }
+
+  powers[0] = 1.0 - coeff;
+  for(int i=1; i<vectorSize; i++)
+    powers[i] = powers[i-1] * powers[0];
 }
@@ -1,8 +1,12 @@
 #ifndef rosic_AnalogEnvelope_h
 #define rosic_AnalogEnvelope_h
 
+// standard-library includes:
+#include <climits>
+
 // rosic-indcludes:
 #include "rosic_RealFunctions.h"
+#include "rosic_FunctionTemplates.h"
 
 namespace rosic
 {
@@ -19,6 +23,13 @@ namespace rosic
   the filter reaches 63.2% of the end value (for an incoming step-function). This time constant can 
   be scaled to re-define the ramp time to other values than 63.2%.
 
+  The envelope runs through explicit segments. The lengths of the timed ones (attack, hold, decay)
+  are counted down in samples, the release ends when the output has come close enough to the end 
+  level to snap to it, sustain and the final segment last until the next note event. Each segment
+  is a one-pole filter with a constant coefficient and target, so the per-sample work is a single 
+  filter update. renderBlock() runs whole segments and evaluates the closed-form solution of the 
+  filter within a segment, vectorSize samples at a time.
+
   */
 
   class AnalogEnvelope
@@ -26,6 +37,17 @@ namespace rosic
 
   public:
 
+    /** Enumeration of the segments of the envelope. */
+    enum segments
+    {
+      ATTACK = 0,
+      HOLD,
+      DECAY,
+      SUSTAIN,
+      RELEASE,
+      DONE
+    };
+
     //---------------------------------------------------------------------------------------------
     // construction/destruction:
 
@@ -51,7 +73,7 @@ namespace rosic
     void setStartInSemitones(double newStart) { setStartLevel(pitchOffsetToFreqFactor(newStart)); }  
 
     /** Sets the highest point of the envelope (as raw value). */
-    void setPeakLevel(double newPeak) { peakLevel = newPeak; }
+    void setPeakLevel(double newPeak) { peakLevel = newPeak; loadSegment(false); }
 
     /** Sets the highest point of the envelope (in dB). */
     void setPeakInDecibels(double newPeak) { setPeakLevel(dB2amp(newPeak)); }
@@ -74,7 +96,7 @@ namespace rosic
     { setPeakLevelByVel(pitchOffsetToFreqFactor(newPeakByVel)); }
 
     /** Sets the sustain level (as raw value). */
-    void setSustainLevel(double newSustain) { sustainLevel = newSustain; }
+    void setSustainLevel(double newSustain) { sustainLevel = newSustain; loadSegment(false); }
 
     /** Sets the sustain level (in dB). */
     void setSustainInDecibels(double newSustain) { setSustainLevel(dB2amp(newSustain)); }
@@ -84,7 +106,7 @@ namespace rosic
     { setSustainLevel(pitchOffsetToFreqFactor(newSustain)); }
 
     /** Sets the end point of the envelope (as raw value). */
-    void setEndLevel(double newEnd) { endLevel = newEnd; }
+    void setEndLevel(double newEnd) { endLevel = newEnd; loadSegment(true); }
 
     /** Sets the end point of the envelope (in dB). */
     void setEndInDecibels(double newEnd) { setEndLevel(dB2amp(newEnd)); }
@@ -117,7 +139,7 @@ namespace rosic
     void setPeakScale(double newPeakScale); 
 
     /** Sets the internal state of the RC-filter. */
-    void setInternalState(double newState) { previousOutput = newState; }
+    void setInternalState(double newState) { previousOutput = newState; loadSegment(true); }
 
     //---------------------------------------------------------------------------------------------
     // inquiry:
@@ -137,6 +159,9 @@ namespace rosic
     /** Returns, when currently a note is on (the noteIsOn flag is set). */
     bool isNoteOn() const { return noteIsOn; }
 
+    /** Returns the segment, the envelope is currently in (one of the values in segments). */
+    int getSegment() const { return segment; }
+
     /** True, if output is below 40 dB. */
     bool endIsReached();  
 
@@ -146,6 +171,12 @@ namespace rosic
     /** Calculates one output sample at a time. */
     INLINE double getSample();    
 
+    /** Calculates a block of output samples. Within a segment, the output is 
+    target + (y0-target) * (1-coeff)^n, so this computes vectorSize samples at a time from the 
+    powers of 1-coeff without a serial dependency between them. The results are equal to those of 
+    successive calls to getSample() up to rounding. */
+    void renderBlock(double* buffer, int numSamples);
+
     //---------------------------------------------------------------------------------------------
     // others:
 
@@ -157,14 +188,37 @@ namespace rosic
     /** Causes the envelope to start with its release-phase. */
     void noteOff();  
 
-    /** Resets the time variable. */
+    /** Restarts the current note from the beginning of the attack segment (without resetting the
+    level). */
     void reset();   
 
   protected:
 
-    /** Calculates our members that represent accumulated time values from attack, hold, etc. */
+    /** Calculates our members that represent accumulated time values from attack, hold, etc. and
+    the segment boundaries in samples. When we are in a timed segment, the segment is shortened or
+    lengthened to the new boundary. */
     void calculateAccumulatedTimes();
 
+    /** Returns the number of samples since note-on, for which the time is still within the given
+    time (in milliseconds). */
+    int getNumSamplesUpTo(double timeInMilliseconds) const;
+
+    /** Returns the end of a timed segment as number of samples since note-on. Untimed segments
+    don't have an end. */
+    int getSegmentEnd(int segmentIndex) const;
+
+    /** Switches to the given segment - or beyond that, when the given segment has already ended. */
+    void enterSegment(int newSegment);
+
+    /** Called when the current segment has run out of samples. */
+    void enterNextSegment();
+
+    /** Loads the coefficient and target of the current segment. In the release, the length is
+    computed from the distance to the end level, when that has changed (on entering the release 
+    or when the level or the end level are set) - otherwise it is only rescaled to the current 
+    release coefficient. */
+    void loadSegment(bool distanceChanged);
+
     // level and time parameters:
     double startLevel, peakLevel, sustainLevel, endLevel;  
     double attackTime, holdTime, decayTime, releaseTime;    // in seconds
@@ -173,13 +227,25 @@ namespace rosic
     // accumulated time values:
     double attPlusHld, attPlusHldPlusDec, attPlusHldPlusDecPlusRel;
 
-    double time;       // time since the last call to to trigger() 
+    // segment state:
+    int    segment;      // the current segment, one of the values in segments
+    int    samplesLeft;  // number of samples until the next segment begins
+    int    segmentEnd;   // samples since note-on at the end of the current segment (timed ones)
+    int    attackEnd, holdEnd, decayEnd; // the segment boundaries in samples since note-on
+    double coeff;        // filter coefficient of the current segment
+    double target;       // level, the current segment approaches
+
+    static const int vectorSize = 4; // number of samples that renderBlock computes at a time
+    double powers[vectorSize];        // (1-coeff)^1 ... (1-coeff)^vectorSize
+
     double timeScale;  // scale the time constants in the filters according to
     double increment;  // increment for the time variable per sample 
     double tauScale;   // scale factor for the time constants of the filters
     double peakScale;  // scale factor for the peak-value
 
     double attackCoeff,  decayCoeff, releaseCoeff;   // filter coefficients
+    double releaseLogDecay;     // log(1-releaseCoeff), 0 for an instant release
+    double samplesLeftLogDecay; // releaseLogDecay that the release length was computed with
     double previousOutput;                           // previous output sample
     double sampleRate;                               // sample-rate
     bool   outputIsZero;                             // indicates if envelope has reached its end
@@ -192,41 +258,15 @@ namespace rosic
 
   INLINE double AnalogEnvelope::getSample()
   {
-    double out;
-
-    // attack or hold phase:
-    if(time <= attPlusHld)   // noteIsOn has not to be checked, because, time is advanced to the 
-                             // beginning of the release phase in noteOff()
-    {
-      out   = previousOutput + attackCoeff * (peakScale*peakLevel - previousOutput);
-      time += increment;
-    }
-
-    // decay phase:
-    else if(time <= (attPlusHldPlusDec)) // noteIsOn has not to be checked
-    {
-      out   = previousOutput + decayCoeff * (sustainLevel - previousOutput);
-      time += increment;
-    }
-
-    // sustain phase:
-    else if(noteIsOn)
-    {
-      out = previousOutput + decayCoeff * (sustainLevel - previousOutput);
-      // time is not incremented in sustain
-    }
-
-    // release phase:
-    else
-    {
-      out   = previousOutput + releaseCoeff * (endLevel - previousOutput);
-      time += increment;
-    }
+    if( samplesLeft == 0 )
+      enterNextSegment();
+    samplesLeft--;
 
     // store output sample for next call:
-    previousOutput = out; // + TINY;  // TINY is to avoid denorm problems
+    previousOutput = previousOutput + coeff * (target - previousOutput); // + TINY;  
+      // TINY is to avoid denorm problems
 
-    return out;
+    return previousOutput;
   }
 
 } // end namespace rosic
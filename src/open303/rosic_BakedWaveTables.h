@@ -0,0 +1,30 @@
+#ifndef rosic_BakedWaveTables_h
+#define rosic_BakedWaveTables_h
+
+// rosic-indcludes:
+#include "rosic_MipMappedWaveTable.h"
+
+namespace rosic
+{
+
+  /**
+
+  A mip-map that was rendered at build time by tools/BakeWaveTables.cpp, together with the
+  parameters it was rendered for. The definitions are generated into the build folder, so they are
+  always in sync with the code that renders the tables at runtime.
+
+  */
+
+  struct BakedMipMap
+  {
+    MipMappedWaveTable::WaveformParameters parameters;
+    const double* mipMap;
+  };
+
+  extern const BakedMipMap bakedMipMaps[];
+  extern const int         numBakedMipMaps;
+  extern const int         bakedMipMapSize; // number of values per mip-map
+
+} // end namespace rosic
+
+#endif // rosic_BakedWaveTables_h
@@ -0,0 +1,99 @@
+#include "rosic_BiquadCascade.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+BiquadCascade::BiquadCascade()
+{
+  for(int i=0; i<maxNumStages; i++)
+    setStageCoefficients(i, 1.0, 0.0, 0.0, 0.0, 0.0);
+  numStages = 1;
+  reset();    
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void BiquadCascade::setNumStages(int newNumStages)
+{
+  newNumStages = clip(newNumStages, 1, (int)maxNumStages);
+  for(int i=numStages; i<newNumStages; i++)
+  {
+    setStageCoefficients(i, 1.0, 0.0, 0.0, 0.0, 0.0);
+    s1[i] = s2[i] = 0.0;
+  }
+  numStages = newNumStages;
+}
+
+void BiquadCascade::setStageCoefficients(int stage, double newB0, double newB1, double newB2, 
+  double newA1, double newA2)
+{
+  if( stage < 0 || stage >= maxNumStages )
+    return;
+  b0[stage] = newB0;
+  b1[stage] = newB1;
+  b2[stage] = newB2;
+  a1[stage] = newA1;
+  a2[stage] = newA2;
+}
+
+void BiquadCascade::setStageFromFirstOrderPair(int stage, double b0A, double b1A, double a1A, 
+  double b0B, double b1B, double a1B)
+{
+  // (b0A + b1A/z) / (1 - a1A/z) * (b0B + b1B/z) / (1 - a1B/z):
+  setStageCoefficients(stage, b0A*b0B, b0A*b1B + b1A*b0B, b1A*b1B, a1A+a1B, -a1A*a1B);
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+void BiquadCascade::getStageCoefficients(int stage, double* outB0, double* outB1, double* outB2, 
+  double* outA1, double* outA2) const
+{
+  if( stage < 0 || stage >= maxNumStages )
+    return;
+  *outB0 = b0[stage];
+  *outB1 = b1[stage];
+  *outB2 = b2[stage];
+  *outA1 = a1[stage];
+  *outA2 = a2[stage];
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void BiquadCascade::processBlock(const double* in, double* out, int numSamples)
+{
+  if( numSamples <= 0 )
+    return;
+
+  for(int n=0; n<numSamples; n++)
+    out[n] = ANTI_DENORMAL(in[n]);
+
+  // one stage at a time over the whole block with its coefficients and states in registers:
+  for(int i=0; i<numStages; i++)
+  {
+    double c0 = b0[i], c1 = b1[i], c2 = b2[i], d1 = a1[i], d2 = a2[i];
+    double t1 = s1[i], t2 = s2[i];
+    for(int n=0; n<numSamples; n++)
+    {
+      double x = out[n];
+      double y = c0*x + t1;
+      t1       = c1*x + d1*y + t2;
+      t2       = c2*x + d2*y;
+      out[n]   = y;
+    }
+    s1[i] = t1;
+    s2[i] = t2;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+void BiquadCascade::reset()
+{
+  for(int i=0; i<maxNumStages; i++)
+    s1[i] = s2[i] = 0.0;
+}
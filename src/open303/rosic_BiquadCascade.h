@@ -0,0 +1,111 @@
+#ifndef rosic_BiquadCascade_h
+#define rosic_BiquadCascade_h
+
+// rosic-indcludes:
+#include "rosic_RealFunctions.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a series connection of up to maxNumStages biquad stages with fixed coefficients, each
+  implemented in transposed direct form II (two state variables per stage). It is meant for fixed
+  filter chains that are set up once per sample rate: the coefficients of the individual filters
+  are obtained from their designers (OnePoleFilter, BiquadFilter) and combined here, such that
+  the chain runs as one tight recursion instead of a sequence of separate filter objects. 
+
+  The coefficients use the same sign convention as the other rosic filters: 
+  y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] + a1*y[n-1] + a2*y[n-2].
+
+  */
+
+  class BiquadCascade
+  {
+
+  public:
+
+    enum constants
+    {
+      maxNumStages = 4
+    };
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. Initializes the cascade with a single bypass stage. */
+    BiquadCascade();   
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the number of stages (1...maxNumStages). Stages beyond the old number are set to 
+    bypass. */
+    void setNumStages(int newNumStages);
+
+    /** Sets the coefficients of one stage. */
+    void setStageCoefficients(int stage, double newB0, double newB1, double newB2, double newA1, 
+      double newA2);
+
+    /** Sets one stage to the product of two first order filters (with coefficients as in 
+    OnePoleFilter). */
+    void setStageFromFirstOrderPair(int stage, double b0A, double b1A, double a1A, double b0B, 
+      double b1B, double a1B);
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry
+
+    /** Returns the number of stages. */
+    int getNumStages() const { return numStages; }
+
+    /** Retrieves the coefficients of one stage. */
+    void getStageCoefficients(int stage, double* outB0, double* outB1, double* outB2, 
+      double* outA1, double* outA2) const;
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Calculates a single filtered output-sample. */
+    INLINE double getSample(double in);
+
+    /** Filters a block of samples, stage by stage over the whole block. The buffer may be used in 
+    place (in == out). */
+    void processBlock(const double* in, double* out, int numSamples);
+
+    //---------------------------------------------------------------------------------------------
+    // others:
+
+    /** Resets the state variables of all stages to zero. */
+    void reset();
+
+    //=============================================================================================
+
+  protected:
+
+    double b0[maxNumStages], b1[maxNumStages], b2[maxNumStages];
+    double a1[maxNumStages], a2[maxNumStages];
+    double s1[maxNumStages], s2[maxNumStages];  // state variables
+    int    numStages;
+
+  };
+
+  //-----------------------------------------------------------------------------------------------
+  // inlined functions:
+
+  INLINE double BiquadCascade::getSample(double in)
+  {
+    // the TINY is added once for the whole chain:
+    double y = ANTI_DENORMAL(in);
+    for(int i=0; i<numStages; i++)
+    {
+      double x = y;
+      y     = b0[i]*x + s1[i];
+      s1[i] = b1[i]*x + a1[i]*y + s2[i];
+      s2[i] = b2[i]*x + a2[i]*y;
+    }
+    return y;
+  }
+
+} // end namespace rosic
+
+#endif // rosic_BiquadCascade_h
@@ -75,6 +75,11 @@ namespace rosic
     /** Returns the bandwidth in octaves. */
     double getBandwidth() const { return bandwidth; }
 
+    /** Retrieves the filter coefficients (for combining them with other filters). */
+    void getCoefficients(double* outB0, double* outB1, double* outB2, double* outA1, 
+      double* outA2) const
+    { *outB0 = b0; *outB1 = b1; *outB2 = b2; *outA1 = a1; *outA2 = a2; }
+
     //---------------------------------------------------------------------------------------------
     // audio processing:
 
@@ -109,7 +114,7 @@ namespace rosic
   INLINE double BiquadFilter::getSample(double in)
   {
     // calculate the output sample:
-    double y = b0*in + b1*x1 + b2*x2 + a1*y1 + a2*y2 + TINY;
+    double y = ANTI_DENORMAL(b0*in + b1*x1 + b2*x2 + a1*y1 + a2*y2);
 
     // update the buffer variables:
     x2 = x1;
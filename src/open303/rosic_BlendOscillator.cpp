@@ -13,6 +13,11 @@ BlendOscillator::BlendOscillator()
   increment            = (tableLengthDbl*freq)/sampleRate;
   phaseIndex           = 0.0;
   startIndex           = 0.0;
+  blend                = 0.0;
+  blendMode            = BLEND_WAVEFORM1_ONLY;
+  interpolation        = MipMappedWaveTable::LINEAR;
+  if( MipMappedWaveTable::tableLength < 1024 )
+    interpolation = MipMappedWaveTable::CUBIC_HERMITE;
   waveTable1           = NULL;
   waveTable2           = NULL;
 
@@ -41,6 +46,7 @@ void BlendOscillator::setSampleRate(double newSampleRate)
     sampleRate = newSampleRate;
   sampleRateRec = 1.0 / sampleRate;
   increment = tableLengthDbl*freq*sampleRateRec;
+  updateNumTablesToRender();
 }
 
 void BlendOscillator::setWaveForm1(int newWaveForm1)
@@ -55,14 +61,34 @@ void BlendOscillator::setWaveForm2(int newWaveForm2)
     waveTable2->setWaveform(newWaveForm2);
 }
 
+void BlendOscillator::setBlendFactor(double newBlendFactor)
+{
+  blend = newBlendFactor;
+  if( blend == 0.0 )
+    blendMode = BLEND_WAVEFORM1_ONLY;
+  else if( blend == 1.0 )
+    blendMode = BLEND_WAVEFORM2_ONLY;
+  else
+    blendMode = BLEND_MIXED;
+}
+
+void BlendOscillator::setInterpolation(int newInterpolation)
+{
+  if( newInterpolation >= MipMappedWaveTable::LINEAR 
+    && newInterpolation <= MipMappedWaveTable::LAGRANGE )
+    interpolation = newInterpolation;
+}
+
 void BlendOscillator::setWaveTable1(MipMappedWaveTable* newWaveTable1)
 {
   waveTable1 = newWaveTable1;
+  updateNumTablesToRender();
 }
 
 void BlendOscillator::setWaveTable2(MipMappedWaveTable* newWaveTable2)
 {
   waveTable2 = newWaveTable2;
+  updateNumTablesToRender();
 }
 
 void BlendOscillator::setStartPhase(double StartPhase)
@@ -71,6 +97,26 @@ void BlendOscillator::setStartPhase(double StartPhase)
     startIndex = (StartPhase/360.0)*tableLengthDbl;
 }
 
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+int BlendOscillator::getNumReachableTables() const
+{
+  // setFrequency accepts frequencies below 20 kHz only:
+  return getTableIndex(tableLengthDbl*20000.0*sampleRateRec) + 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+void BlendOscillator::updateNumTablesToRender()
+{
+  if( waveTable1 != NULL )
+    waveTable1->setNumTablesToRender(getNumReachableTables());
+  if( waveTable2 != NULL )
+    waveTable2->setNumTablesToRender(getNumReachableTables());
+}
+
 //-------------------------------------------------------------------------------------------------
 // event processing:
 
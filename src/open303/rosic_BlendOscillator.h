@@ -20,6 +20,14 @@ namespace rosic
 
   public:
 
+    /** Enumeration of the kernels for getSample. The pure ones touch only one of the tables. */
+    enum blendModes
+    {
+      BLEND_MIXED = 0,
+      BLEND_WAVEFORM1_ONLY,
+      BLEND_WAVEFORM2_ONLY
+    };
+
     //---------------------------------------------------------------------------------------------
     // construction/destruction:
 
@@ -32,7 +40,8 @@ namespace rosic
     //---------------------------------------------------------------------------------------------
     // parameter settings:
 
-    /** Sets the sample-rateRate(). */
+    /** Sets the sample-rateRate(). This also tells the wavetables how many of their bandlimited 
+    tables can be reached at all (@see MipMappedWaveTable::setNumTablesToRender). */
     void setSampleRate(double newSampleRate);
 
     /** Sets the 1st waveform of the oscillator. */
@@ -56,7 +65,7 @@ namespace rosic
     /** Sets the blend/mix factor between the two waveforms. The value is expected between 0...1
     where 0 means waveform1 only, 1 means waveform2 only - in between there will be a linear blend
     between the two waveforms. */
-    void setBlendFactor(double newBlendFactor) { blend = newBlendFactor; }
+    void setBlendFactor(double newBlendFactor);
 
     /** Sets the frequency of the oscillator. */
     INLINE void setFrequency(double newFrequency);
@@ -67,6 +76,11 @@ namespace rosic
     /** Sets the phase increment from outside. */
     INLINE void setIncrement(double newIncrement) { increment = newIncrement; }
 
+    /** Selects the interpolation method for the table lookup (one of the values in 
+    MipMappedWaveTable::interpolationMethods). The default is linear interpolation for tables of
+    length 1024 and cubic Hermite interpolation for shorter ones. */
+    void setInterpolation(int newInterpolation);
+
     //---------------------------------------------------------------------------------------------
     // inquiry:
 
@@ -75,15 +89,39 @@ namespace rosic
     the two waveforms. */
     double getBlendFactor() const { return blend; }
 
+    /** Returns the mode that matches the current blend factor (@see blendModes). */
+    INLINE int getBlendMode() const { return blendMode; }
+
+    /** Returns the interpolation method for the table lookup. @see setInterpolation */
+    INLINE int getInterpolation() const { return interpolation; }
+
+    /** Returns the index of the kernel for the current blend mode and interpolation method, 
+    which is 3*interpolation + blendMode. Callers that produce many samples in a row should pick 
+    the kernel once via this function and call the specialized getSample<kernel>() version in 
+    their loop. */
+    INLINE int getKernel() const { return 3*interpolation + blendMode; }
+
     /** Returns the phase increment. */
     INLINE double getIncrement() const { return increment; }
 
+    /** Returns the index of the bandlimited table that is used for the given phase increment. */
+    INLINE static int getTableIndex(double increment);
+
+    /** Returns the number of bandlimited tables that can be reached with frequencies that are 
+    accepted by setFrequency at the current sample rate. */
+    int getNumReachableTables() const;
+
     //---------------------------------------------------------------------------------------------
     // audio processing:
 
     /** Calculates one output sample at a time. */
     INLINE double getSample();
 
+    /** Calculates one output sample with the given kernel, which must match getKernel(). The 
+    results are identical to those of getSample(). */
+    template<int kernel>
+    INLINE double getSample();
+
     //---------------------------------------------------------------------------------------------
     // others:
 
@@ -91,6 +129,9 @@ namespace rosic
     pulseWidth. */
     INLINE void calculateIncrement();
 
+    /** Passes the number of reachable tables to the wavetables. */
+    void updateNumTablesToRender();
+
     /** Resets the phaseIndex to startIndex. */
     void resetPhase();
 
@@ -106,6 +147,8 @@ namespace rosic
     double freq;              // frequency of the oscillator
     double increment;         // phase increment per sample
     double blend;             // the blend factor between the two waveforms
+    int    blendMode;         // kernel for the blend factor, one of the values in blendModes
+    int    interpolation;     // interpolation method for the table lookup
     double startIndex;        // start-phase-index of the osc (range: 0 - tableLength)
     double sampleRate;        // the samplerate
     double sampleRateRec;     // 1/sampleRate
@@ -134,8 +177,38 @@ namespace rosic
     increment = tableLengthDbl*freq*sampleRateRec;
   }
 
+  INLINE int BlendOscillator::getTableIndex(double increment)
+  {
+    int tableNumber;
+    tableNumber  = ((int)EXPOFDBL(increment));
+    //tableNumber += 1;           // generate frequencies up to nyquist/2 on the highest note
+    tableNumber += 2;             // generate frequencies up to nyquist/4 on the highest note
+                                  // \todo: make this number adjustable from outside
+    return tableNumber;
+  }
+
   INLINE double BlendOscillator::getSample()
   {
+    switch( getKernel() )
+    {
+    case 0:  return getSample<0>();
+    case 1:  return getSample<1>();
+    case 2:  return getSample<2>();
+    case 3:  return getSample<3>();
+    case 4:  return getSample<4>();
+    case 5:  return getSample<5>();
+    case 6:  return getSample<6>();
+    case 7:  return getSample<7>();
+    default: return getSample<8>();
+    }
+  }
+
+  template<int kernel>
+  INLINE double BlendOscillator::getSample()
+  {
+    const int mode                = kernel % 3;
+    const int interpolationMethod = kernel / 3;
+
     double out1, out2;
     int    tableNumber;
 
@@ -143,10 +216,7 @@ namespace rosic
       return 0.0;
 
     // from this increment, decide which table is to be used:
-    tableNumber  = ((int)EXPOFDBL(increment));
-    //tableNumber += 1;           // generate frequencies up to nyquist/2 on the highest note
-    tableNumber += 2;             // generate frequencies up to nyquist/4 on the highest note
-                                  // \todo: make this number adjustable from outside
+    tableNumber = getTableIndex(increment);
 
     // wraparound if necessary:
     while( phaseIndex>=tableLengthDbl )
@@ -154,14 +224,21 @@ namespace rosic
 
     int    intIndex = floorInt(phaseIndex);
     double frac     = phaseIndex  - (double) intIndex;
-    out1 = (1.0-blend) * waveTable1->getValueLinear(intIndex, frac, tableNumber);
-    out2 =      blend  * waveTable2->getValueLinear(intIndex, frac, tableNumber);
+    phaseIndex += increment;
     
+    // the pure kernels give the same results as the blend with weights 1 and 0:
+    if( mode == BLEND_WAVEFORM1_ONLY )
+      return waveTable1->getValue<interpolationMethod>(intIndex, frac, tableNumber);
+
+    out2  = waveTable2->getValue<interpolationMethod>(intIndex, frac, tableNumber);
     out2 *= 0.5; // \todo: this is preliminary to scale the square in AciDevil we need to
                  // implement something more general here (like a kind of crest-compensation in 
                  // the wavetable-class)
+    if( mode == BLEND_WAVEFORM2_ONLY )
+      return out2;
 
-    phaseIndex += increment;
+    out1 = (1.0-blend) * waveTable1->getValue<interpolationMethod>(intIndex, frac, tableNumber);
+    out2 =      blend  * out2;
     return out1 + out2;
   }
 
@@ -63,6 +63,57 @@ void DecayEnvelope::setNormalizeSum(bool shouldNormalizeSum)
   calculateCoefficient();
 }
 
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void DecayEnvelope::renderBlock(double* buffer, int numSamples)
+{
+  int n = 0;
+  while( n < numSamples )
+  {
+    // the attack lasts as long as getSample() would see time < attackTime, the decay until the
+    // next trigger:
+    int numInPhase = 0;
+    const double* powers;
+    double target;
+    if( time < attackTime )
+    {
+      while( time < attackTime && n+numInPhase < numSamples )
+      {
+        time += timeIncrement;
+        numInPhase++;
+      }
+      powers = attackPowers;
+      target = yInit;
+    }
+    else
+    {
+      numInPhase = numSamples-n;
+      powers     = decayPowers;
+      target     = 0.0;
+    }
+
+    // closed-form solution - only the distance to the target is carried from one vector to the 
+    // next:
+    double* out      = buffer + n;
+    double  distance = y - target;
+    int     i, j;
+    for(i=0; i+vectorSize<=numInPhase; i+=vectorSize)
+    {
+      for(j=0; j<vectorSize; j++)
+        out[i+j] = target + distance*powers[j];
+      distance *= powers[vectorSize-1];
+    }
+    for(j=0; i+j<numInPhase; j++)
+      out[i+j] = target + distance*powers[j];
+    if( j > 0 )
+      distance *= powers[j-1];
+
+    y  = target + distance;
+    n += numInPhase;
+  }
+}
+
 //-------------------------------------------------------------------------------------------------
 // others:
 
@@ -104,4 +155,13 @@ void DecayEnvelope::calculateCoefficient()
     yInit = (1.0-c)/c;
   else  
     yInit = 1.0/c; // Slightly > 1.0 to compensate for first multiply, keeps peak at 1.0
+
+  // 4. Powers for the block processing
+  attackPowers[0] = 1.0 - attackCoeff;
+  decayPowers[0]  = c;
+  for(int i=1; i<vectorSize; i++)
+  {
+    attackPowers[i] = attackPowers[i-1] * attackPowers[0];
+    decayPowers[i]  = decayPowers[i-1]  * decayPowers[0];
+  }
 }
\ No newline at end of file
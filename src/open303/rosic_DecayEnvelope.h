@@ -56,6 +56,12 @@ namespace rosic
     /** Calculates one output sample at a time. */
     INLINE double getSample();    
 
+    /** Calculates a block of output samples. Attack and decay both approach their target 
+    exponentially, so this computes vectorSize samples at a time from powers of the respective 
+    coefficient without a serial dependency between them. The results are equal to those of 
+    successive calls to getSample() up to rounding. */
+    void renderBlock(double* buffer, int numSamples);
+
     //---------------------------------------------------------------------------------------------
     // others:
 
@@ -81,6 +87,10 @@ namespace rosic
     double fs;            // sample-rate
     bool   normalizeSum; 
 
+    static const int vectorSize = 4;    // number of samples that renderBlock computes at a time
+    double attackPowers[vectorSize];     // (1-attackCoeff)^1 ... (1-attackCoeff)^vectorSize
+    double decayPowers[vectorSize];      // c^1 ... c^vectorSize
+
   };
 
   //-----------------------------------------------------------------------------------------------
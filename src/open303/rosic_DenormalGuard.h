@@ -0,0 +1,89 @@
+#ifndef rosic_DenormalGuard_h
+#define rosic_DenormalGuard_h
+
+// standard-library includes:
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define ROSIC_DENORMAL_GUARD_SSE
+#elif defined(__aarch64__)
+#define ROSIC_DENORMAL_GUARD_AARCH64
+#endif
+
+// rosic-indcludes:
+#include "GlobalDefinitions.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a scope guard that switches the floating point unit of the calling thread into 
+  flush-to-zero / denormals-are-zero mode for its lifetime and restores the previous mode when it 
+  goes out of scope. Put one on the stack around the engine processing: denormal numbers that 
+  appear in decaying filter states (the TB_303 ladder for example has no other protection) are 
+  then treated as zero instead of taking the slow path through microcode.
+
+  On x86 this sets the FTZ and DAZ bits of the MXCSR, on AArch64 the FZ bit of the FPCR (which 
+  flushes inputs and outputs). On other platforms it does nothing. The mode register is only 
+  written when the mode actually changes, so a guard inside an outer guard (or on a thread that 
+  the host already runs in flush-to-zero mode) costs just a register read.
+
+  */
+
+  class DenormalGuard
+  {
+
+  public:
+
+    /** Constructor. Enables flush-to-zero mode. */
+    INLINE DenormalGuard()
+    {
+      oldMode = getMode();
+      if( (oldMode & flushMask) != flushMask )
+        setMode(oldMode | flushMask);
+    }
+
+    /** Destructor. Restores the previous mode. */
+    INLINE ~DenormalGuard()
+    {
+      if( (oldMode & flushMask) != flushMask )
+        setMode(oldMode);
+    }
+
+  protected:
+
+#if defined(ROSIC_DENORMAL_GUARD_SSE)
+    typedef unsigned int modeType;
+    static const modeType flushMask = 0x8040; // FTZ (bit 15) and DAZ (bit 6)
+    static INLINE modeType getMode() { return _mm_getcsr(); }
+    static INLINE void setMode(modeType mode) { _mm_setcsr(mode); }
+#elif defined(ROSIC_DENORMAL_GUARD_AARCH64)
+    typedef unsigned long long modeType;
+    static const modeType flushMask = 1ULL << 24; // FZ
+    static INLINE modeType getMode() 
+    { 
+      modeType mode; 
+      __asm__ __volatile__("mrs %0, fpcr" : "=r"(mode)); 
+      return mode; 
+    }
+    static INLINE void setMode(modeType mode) { __asm__ __volatile__("msr fpcr, %0" : : "r"(mode)); }
+#else
+    typedef unsigned int modeType;
+    static const modeType flushMask = 0;
+    static INLINE modeType getMode() { return 0; }
+    static INLINE void setMode(modeType /*mode*/) {}
+#endif
+
+    modeType oldMode;
+
+  private:
+
+    // a guard belongs to one scope on one thread:
+    DenormalGuard(const DenormalGuard&);
+    DenormalGuard& operator=(const DenormalGuard&);
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_DenormalGuard_h
@@ -12,7 +12,8 @@ FourierTransformerRadix2::FourierTransformerRadix2()
   direction           = FORWARD;
   normalizationMode   = NORMALIZE_ON_INVERSE_TRAFO;
   normalizationFactor = 1.0;
-  w                   = NULL;
+  realPlan            = NULL;
+  complexPlan         = NULL;
   ip                  = NULL;
   tmpBuffer           = NULL;
 
@@ -22,8 +23,6 @@ FourierTransformerRadix2::FourierTransformerRadix2()
 FourierTransformerRadix2::~FourierTransformerRadix2()
 {
   // free dynamically allocated memory:
-  if( w != NULL )
-    delete[] w;
   if( ip != NULL )
     delete[] ip;
   if( tmpBuffer != NULL )
@@ -46,18 +45,16 @@ void FourierTransformerRadix2::setBlockSize(int newBlockSize)
       logN = (int) floor( log2((double) N + 0.5 ) );
       updateNormalizationFactor();
 
-      if( w != NULL )
-        delete[] w;
-      w    = new double[2*N];
+      realPlan    = NULL;
+      complexPlan = NULL;
 
       if( ip != NULL )
         delete[] ip;
       ip    = new int[(int) ceil(4.0+sqrt((double)N))];
-      ip[0] = 0; // indicate that re-initialization is necesarry
 
       if( tmpBuffer != NULL )
         delete[] tmpBuffer;
-      tmpBuffer = new Complex[N];
+      tmpBuffer = NULL;
     }
   }
   else if( !isPowerOfTwo(newBlockSize) || newBlockSize <= 1 )
@@ -92,11 +89,6 @@ void FourierTransformerRadix2::setNormalizationMode(int newNormalizationMode)
     DEBUG_BREAK; // passed int-parameter does not correspond to any meaningful enum-field
 }
 
-void FourierTransformerRadix2::setRealSignalMode(bool willBeUsedForRealSignals)
-{
-  ip[0] = 0; // retriggers twiddle-factor computation
-}
-
 //-------------------------------------------------------------------------------------------------
 // signal processing:
 
@@ -119,7 +111,7 @@ void FourierTransformerRadix2::transformComplexBufferInPlace(Complex *buffer)
     sign = -1;
   else
     sign = +1;
-  cdft(2*N, sign, d_buffer, ip, w);
+  cdft(2*N, sign, d_buffer, ip, preparePlan(false));
 }
 
 void FourierTransformerRadix2::transformComplexBuffer(Complex *inBuffer, Complex *outBuffer)
@@ -148,7 +140,7 @@ void FourierTransformerRadix2::transformComplexBuffer(Complex *inBuffer, Complex
     sign = -1;
   else
     sign = +1;
-  cdft(2*N, sign, d_outBuffer, ip, w);
+  cdft(2*N, sign, d_outBuffer, ip, preparePlan(false));
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -176,7 +168,7 @@ void FourierTransformerRadix2::transformRealSignal(double *inSignal, Complex *ou
   }
 
   // use Ooura's routine:
-  rdft(N, 1, d_outBuffer, ip, w);
+  rdft(N, 1, d_outBuffer, ip, preparePlan(true));
 
   // for some reason, this routine returns the second half of the spectrum (the complex conjugate 
   // values of the desired first half), so we need to take the complex conjugates:
@@ -194,6 +186,7 @@ void FourierTransformerRadix2::transformRealSignal(double *signal, double *reAnd
 void FourierTransformerRadix2::getRealSignalMagnitudesAndPhases(double *signal, 
                                                                 double *magnitudes, double *phases)
 {
+  Complex* tmpBuffer = getTmpBuffer();
   transformRealSignal(signal, tmpBuffer);
 
   // store the two purely real transform values at DC and Nyquist-frequency in the first fields of 
@@ -219,6 +212,7 @@ void FourierTransformerRadix2::getRealSignalMagnitudesAndPhases(double *signal,
 
 void FourierTransformerRadix2::getRealSignalMagnitudes(double *signal, double *magnitudes)
 {
+  Complex* tmpBuffer = getTmpBuffer();
   transformRealSignal(signal, tmpBuffer);
   magnitudes[0] = tmpBuffer[0].re;
 
@@ -260,7 +254,7 @@ void FourierTransformerRadix2::transformSymmetricSpectrum(Complex *inSpectrum, d
     outSignal[n] = -outSignal[n];
 
   // use Ooura's routine:
-  rdft(N, -1, outSignal, ip, w);
+  rdft(N, -1, outSignal, ip, preparePlan(true));
 }
 
 void FourierTransformerRadix2::transformSymmetricSpectrum(double *reAndIm, double *signal)
@@ -273,6 +267,7 @@ void FourierTransformerRadix2::getRealSignalFromMagnitudesAndPhases(double *magn
                                                                     double *phases, 
                                                                     double *signal)
 {
+  Complex* tmpBuffer = getTmpBuffer();
   tmpBuffer[0].re = magnitudes[0];
   tmpBuffer[0].im = phases[0];
 
@@ -292,6 +287,66 @@ void FourierTransformerRadix2::getRealSignalFromMagnitudesAndPhases(double *magn
 //-------------------------------------------------------------------------------------------------
 // pre-calculations:
 
+FourierTransformerRadix2::PlanCache::~PlanCache()
+{
+  for(unsigned int i=0; i<plans.size(); i++)
+  {
+    delete[] plans[i]->w;
+    delete plans[i];
+  }
+}
+
+const FourierTransformerRadix2::Plan* FourierTransformerRadix2::getPlan(int blockSize, 
+                                                                        bool forRealSignals)
+{
+  static PlanCache cache;
+  std::lock_guard<std::mutex> lock(cache.mutex);
+
+  for(unsigned int i=0; i<cache.plans.size(); i++)
+  {
+    if( cache.plans[i]->N == blockSize && cache.plans[i]->forRealSignals == forRealSignals )
+      return cache.plans[i];
+  }
+
+  // compute the tables in the same way as Ooura's routines do it on their first call, such that
+  // they will find them valid and never write into them:
+  Plan* plan           = new Plan;
+  plan->N              = blockSize;
+  plan->forRealSignals = forRealSignals;
+  plan->w              = new double[2*blockSize];
+  int* tmpIp           = new int[(int) ceil(4.0+sqrt((double)blockSize))];
+  if( forRealSignals )
+  {
+    makewt(blockSize >> 2, tmpIp, plan->w);
+    makect(blockSize >> 2, tmpIp, plan->w + tmpIp[0]);
+  }
+  else
+    makewt((2*blockSize) >> 2, tmpIp, plan->w);
+  plan->nw = tmpIp[0];
+  plan->nc = tmpIp[1];
+  delete[] tmpIp;
+
+  cache.plans.push_back(plan);
+  return plan;
+}
+
+double* FourierTransformerRadix2::preparePlan(bool forRealSignals)
+{
+  const Plan*& plan = forRealSignals ? realPlan : complexPlan;
+  if( plan == NULL )
+    plan = getPlan(N, forRealSignals);
+  ip[0] = plan->nw;
+  ip[1] = plan->nc;
+  return plan->w; // Ooura's routines take a non-const pointer but only read from it
+}
+
+Complex* FourierTransformerRadix2::getTmpBuffer()
+{
+  if( tmpBuffer == NULL )
+    tmpBuffer = new Complex[N];
+  return tmpBuffer;
+}
+
 void FourierTransformerRadix2::updateNormalizationFactor()
 {
   if( (normalizationMode == NORMALIZE_ON_FORWARD_TRAFO && direction == FORWARD) ||
@@ -3,6 +3,8 @@
 
 // standard includes:
 #include <stdio.h>
+#include <mutex>
+#include <vector>
 
 // rosic-indcludes:
 #include "rosic_Complex.h"
@@ -22,6 +24,12 @@ namespace rosic
   class FourierTransfromerRadix2Clean which goes without such nasty hacks but is vastly inferior 
   efficiency-wise.
 
+  The twiddle factors depend only on the block size and on whether the object is used for real or
+  complex signals, so they are kept in plans that are shared by all objects in the process. A plan
+  is computed by the first object that needs it and is never modified afterwards, so objects on
+  different threads may use the same plan at the same time. An object may be used for real and
+  complex transforms in turn - it looks up the plan for each signal type on first use.
+
   */
 
   class FourierTransformerRadix2  
@@ -64,11 +72,6 @@ namespace rosic
     constant. */
     void setDirection(int newDirection);
 
-    /** When you switch bewteen usage of this object for real or complex signals, you will need to 
-    call this switch-function in between which just triggers a re-computation of the twiddle 
-    factors (which must be different for the two cases). */
-    void setRealSignalMode(bool willBeUsedForRealSignals);
-
     /** Sets the mode for normalization of the output (@see: normalizationModes). */
     void setNormalizationMode(int newNormalizationMode);
 
@@ -138,6 +141,34 @@ namespace rosic
 
   protected:
 
+    /** The twiddle factors for Ooura's routines for one block size and signal type. */
+    struct Plan
+    {
+      int     N;              /**< The blocksize. */
+      bool    forRealSignals; /**< True for rdft, false for cdft. */
+      int     nw, nc;         /**< Sizes of the tables in w, to be passed in ip[0] and ip[1]. */
+      double *w;              /**< Table of the twiddle-factors. */
+    };
+
+    /** The process-wide collection of plans. */
+    struct PlanCache
+    {
+      ~PlanCache();
+      std::mutex         mutex;
+      std::vector<Plan*> plans;
+    };
+
+    /** Returns the shared plan for the given blocksize and signal type - computes it, if this is
+    the first request for it. */
+    static const Plan* getPlan(int blockSize, bool forRealSignals);
+
+    /** Sets up the work-area 'ip' for a call to one of Ooura's routines and returns the twiddle 
+    factors for it. */
+    double* preparePlan(bool forRealSignals);
+
+    /** Returns the temporary storage area - allocates it on first use. */
+    Complex* getTmpBuffer();
+
     /** Updates the normalizationFactor member variable acording to a new blockSize, direction or
     normalizationMode. */
     void updateNormalizationFactor();
@@ -149,10 +180,11 @@ namespace rosic
     double normalizationFactor;  /**< The normalization factor (can be 1, 1/N or 1/sqrt(N)). */
 
     // work-area stuff for Ooura's fft-routines:
-    double *w;                   /**< Table of the twiddle-factors. */
-    int    *ip;                  /**< Work area for bit-reversal (index pointer?). */
+    const Plan *realPlan;        /**< Shared plan for real signals (NULL until first use). */
+    const Plan *complexPlan;     /**< Shared plan for complex signals (NULL until first use). */
+    int        *ip;              /**< Work area for bit-reversal (index pointer?). */
 
-    // our own temporary storage area:
+    // our own temporary storage area (allocated on first use):
     Complex* tmpBuffer;
 
   };
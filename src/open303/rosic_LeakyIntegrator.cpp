@@ -91,6 +91,31 @@ double LeakyIntegrator::getNormalizer(double tau1, double tau2, double fs)
   return 1.0/xp;
 }
 
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void LeakyIntegrator::renderBlock(const double* in, double* out, int numSamples)
+{
+  double b = 1.0 - coeff; // weight of the input
+  int    i, j, k;
+  for(i=0; i+vectorSize<=numSamples; i+=vectorSize)
+  {
+    double x[vectorSize];
+    for(j=0; j<vectorSize; j++)
+      x[j] = b * in[i+j];
+    for(j=0; j<vectorSize; j++)
+    {
+      double y = powers[j+1] * y1;
+      for(k=0; k<=j; k++)
+        y += powers[j-k] * x[k];
+      out[i+j] = y;
+    }
+    y1 = out[i+vectorSize-1];
+  }
+  for(; i<numSamples; i++)
+    out[i] = getSample(in[i]);
+}
+
 //-------------------------------------------------------------------------------------------------
 // others:
 
@@ -105,5 +130,9 @@ void LeakyIntegrator::calculateCoefficient()
     coeff = exp( -1.0 / (sampleRate*0.001*tau)  );
   else
     coeff = 0.0;
+
+  powers[0] = 1.0;
+  for(int i=1; i<=vectorSize; i++)
+    powers[i] = powers[i-1] * coeff;
 }
 
@@ -46,6 +46,11 @@ namespace rosic
     /** Returns the time constant (tau) in milliseconds. */
     double getTimeConstant() const { return tau; }
 
+    /** Returns true when the output has converged to the (constant) input within the given 
+    relative tolerance. In this case, the state is snapped to the input, such that subsequent 
+    calls to getSample with the same input would return exactly that input. */
+    INLINE bool snapIfConverged(double in, double relativeTolerance);
+
     /** Returns the normalizer, required to normalize the impulse response of a series connection 
     of two digital RC-type filters with time constants tau1 and tau2 (in milliseconds) to unity at 
     the given samplerate. */
@@ -57,6 +62,13 @@ namespace rosic
     /** Calculates one sample at a time. */
     INLINE double getSample(double in);
 
+    /** Filters a block of samples (in and out may point to the same buffer). The output after 
+    k+1 samples is coeff^(k+1) * y1 plus a weighted sum of the last k+1 inputs, so this computes 
+    vectorSize samples at a time from the powers of the coefficient with only one serial 
+    dependency per vector. The results are equal to those of successive calls to getSample() up to
+    rounding. */
+    void renderBlock(const double* in, double* out, int numSamples);
+
     //---------------------------------------------------------------------------------------------
     // others:
 
@@ -72,6 +84,9 @@ namespace rosic
 
     double coeff;        // filter coefficient
     double y1;           // previous output sample
+
+    static const int vectorSize = 4;  // number of samples that renderBlock computes at a time
+    double powers[vectorSize+1];       // coeff^0 ... coeff^vectorSize
     double sampleRate;   // the samplerate
     double tau;          // time constant in milliseconds
 
@@ -85,6 +100,14 @@ namespace rosic
     return y1 = in + coeff*(y1-in);
   }
 
+  INLINE bool LeakyIntegrator::snapIfConverged(double in, double relativeTolerance)
+  {
+    if( fabs(y1-in) > relativeTolerance*fabs(in) )
+      return false;
+    y1 = in;
+    return true;
+  }
+
 } // end namespace rosic
 
 #endif 
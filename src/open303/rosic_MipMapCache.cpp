@@ -0,0 +1,379 @@
+#include "rosic_MipMapCache.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace rosic;
+
+// layout of the cache file (native byte order) - bump the version when the layout changes (the
+// rendered tables are versioned by MipMappedWaveTable::renderVersion):
+namespace
+{
+  const char     cacheMagic[8] = { 'R', '3', '0', '3', 'M', 'I', 'P', 'S' };
+  const uint32_t cacheVersion  = 2;
+
+  struct FileHeader
+  {
+    char     magic[8];
+    uint32_t version;
+    uint32_t renderVersion;
+    uint32_t tableLength;
+    uint32_t numTables;
+    // followed by the entries up to the end of the file
+  };
+
+  struct EntryHeader
+  {
+    uint64_t key;
+    int32_t  waveform;
+    int32_t  reserved;
+    double   symmetry;
+    double   tanhShaperFactor;
+    double   tanhShaperOffset;
+    double   squarePhaseShift;
+    uint64_t checksum;
+    // followed by the mip-map data
+  };
+
+  const uint64_t fnvOffset = 14695981039346656037ULL;
+  const uint64_t fnvPrime  = 1099511628211ULL;
+
+  uint64_t fnv1a(const void* data, size_t numBytes, uint64_t hash = fnvOffset)
+  {
+    const unsigned char* bytes = (const unsigned char*) data;
+    for(size_t i=0; i<numBytes; i++)
+    {
+      hash ^= bytes[i];
+      hash *= fnvPrime;
+    }
+    return hash;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+MipMapCache::MipMapCache()
+{
+  fileValid     = false;
+  mappedData    = NULL;
+  mappedSize    = 0;
+  mappingHandle = NULL;
+}
+
+MipMapCache::~MipMapCache()
+{
+  unmapFile();
+  for(size_t i=0; i<heapCopies.size(); i++)
+    delete[] heapCopies[i];
+}
+
+MipMapCache& MipMapCache::getInstance()
+{
+  static MipMapCache instance;
+  return instance;
+}
+
+//-------------------------------------------------------------------------------------------------
+// setup:
+
+void MipMapCache::open(const std::string& newPath)
+{
+  std::lock_guard<std::mutex> fileLock(fileMutex);
+  std::lock_guard<std::mutex> lock(mutex);
+  if( mappedData != NULL )
+    return; // tables may already point into the current mapping, so we can't replace it
+  path = newPath;
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if( file == INVALID_HANDLE_VALUE )
+    return;
+  LARGE_INTEGER fileSize;
+  if( GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= (LONGLONG) sizeof(FileHeader) )
+  {
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if( mapping != NULL )
+    {
+      mappedData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      if( mappedData != NULL )
+      {
+        mappedSize    = (size_t) fileSize.QuadPart;
+        mappingHandle = mapping;
+      }
+      else
+        CloseHandle(mapping);
+    }
+  }
+  CloseHandle(file);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if( fd < 0 )
+    return;
+  struct stat fileInfo;
+  if( fstat(fd, &fileInfo) == 0 && fileInfo.st_size >= (off_t) sizeof(FileHeader) )
+  {
+    void* data = mmap(NULL, (size_t) fileInfo.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if( data != MAP_FAILED )
+    {
+      mappedData = data;
+      mappedSize = (size_t) fileInfo.st_size;
+    }
+  }
+  ::close(fd);
+#endif
+
+  if( mappedData == NULL )
+    return;
+
+  // validate the header and the size (an entry may have been torn by a crash while appending -
+  // then the file is written anew, instead of appending behind it):
+  const FileHeader* header = (const FileHeader*) mappedData;
+  size_t entrySize = sizeof(EntryHeader) + MipMappedWaveTable::mipMapSize*sizeof(double);
+  if(    memcmp(header->magic, cacheMagic, sizeof(cacheMagic)) != 0
+      || header->version       != cacheVersion
+      || header->renderVersion != (uint32_t) MipMappedWaveTable::renderVersion
+      || header->tableLength   != (uint32_t) MipMappedWaveTable::tableLength
+      || header->numTables     != (uint32_t) MipMappedWaveTable::numTables
+      || (mappedSize - sizeof(FileHeader)) % entrySize != 0 )
+  {
+    unmapFile();
+    return;
+  }
+  fileValid = true;
+
+  // collect the entries - their checksums are checked when they are first used (see find), such
+  // that we don't page in the whole file here:
+  size_t numFileEntries = (mappedSize - sizeof(FileHeader)) / entrySize;
+  const char* position = (const char*) mappedData + sizeof(FileHeader);
+  for(size_t i=0; i<numFileEntries; i++)
+  {
+    const EntryHeader* entryHeader = (const EntryHeader*) position;
+    const double*      mipMap      = (const double*) (position + sizeof(EntryHeader));
+    position += entrySize;
+
+    Entry entry;
+    entry.parameters.waveform         = entryHeader->waveform;
+    entry.parameters.symmetry         = entryHeader->symmetry;
+    entry.parameters.tanhShaperFactor = entryHeader->tanhShaperFactor;
+    entry.parameters.tanhShaperOffset = entryHeader->tanhShaperOffset;
+    entry.parameters.squarePhaseShift = entryHeader->squarePhaseShift;
+    entry.key      = getKey(entry.parameters);
+    entry.mipMap   = mipMap;
+    entry.checksum = entryHeader->checksum;
+    entry.verified = false;
+    if( entry.key == entryHeader->key && (int) entries.size() < maxNumEntries )
+      entries.push_back(entry);
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// lookup/storage:
+
+const double* MipMapCache::find(const MipMappedWaveTable::WaveformParameters& p)
+{
+  unsigned long long key = getKey(p);
+  while( true )
+  {
+    const double*      mipMap   = NULL;
+    unsigned long long checksum = 0;
+    bool               verified = true;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for(size_t i=0; i<entries.size(); i++)
+      {
+        if( entries[i].key == key && entries[i].parameters == p )
+        {
+          mipMap   = entries[i].mipMap;
+          checksum = entries[i].checksum;
+          verified = entries[i].verified;
+          break;
+        }
+      }
+    }
+    if( mipMap == NULL || verified )
+      return mipMap;
+
+    // first hit of an entry from the file - check it outside the lock (this pages it in), then
+    // mark it as checked or drop it and look for another entry with these parameters (the file
+    // may contain one that was appended after the broken one):
+    bool ok = getChecksum(mipMap) == checksum;
+    std::lock_guard<std::mutex> lock(mutex);
+    for(size_t i=0; i<entries.size(); i++)
+    {
+      if( entries[i].mipMap == mipMap )
+      {
+        if( ok )
+          entries[i].verified = true;
+        else
+          entries.erase(entries.begin() + i);
+        break;
+      }
+    }
+    if( ok )
+      return mipMap;
+  }
+}
+
+const double* MipMapCache::store(const MipMappedWaveTable::WaveformParameters& p,
+                                 const double* mipMap)
+{
+  Entry entry;
+  entry.key        = getKey(p);
+  entry.parameters = p;
+  entry.mipMap     = NULL;
+  entry.checksum   = getChecksum(mipMap);
+  entry.verified   = true;
+
+  // publish the entry under the lock:
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // another thread may have stored the same tables in the meantime:
+    for(size_t i=0; i<entries.size(); i++)
+    {
+      if( entries[i].key == entry.key && entries[i].parameters == p )
+        return entries[i].mipMap;
+    }
+
+    if( (int) entries.size() >= maxNumEntries )
+      return NULL;
+
+    double* copy = new double[MipMappedWaveTable::mipMapSize];
+    memcpy(copy, mipMap, MipMappedWaveTable::mipMapSize*sizeof(double));
+    heapCopies.push_back(copy);
+    entry.mipMap = copy;
+    entries.push_back(entry);
+  }
+
+  // ...and write it to the file without holding it:
+  appendToFile(entry);
+  return entry.mipMap;
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+unsigned long long MipMapCache::getKey(const MipMappedWaveTable::WaveformParameters& p)
+{
+  // hash the fields one by one (the struct may contain padding):
+  uint64_t hash = fnvOffset;
+  int32_t  waveform = p.waveform;
+  hash = fnv1a(&waveform,           sizeof(waveform),           hash);
+  hash = fnv1a(&p.symmetry,         sizeof(p.symmetry),         hash);
+  hash = fnv1a(&p.tanhShaperFactor, sizeof(p.tanhShaperFactor), hash);
+  hash = fnv1a(&p.tanhShaperOffset, sizeof(p.tanhShaperOffset), hash);
+  hash = fnv1a(&p.squarePhaseShift, sizeof(p.squarePhaseShift), hash);
+  return hash;
+}
+
+unsigned long long MipMapCache::getChecksum(const double* mipMap)
+{
+  return fnv1a(mipMap, MipMappedWaveTable::mipMapSize*sizeof(double));
+}
+
+void MipMapCache::appendToFile(const Entry& entry)
+{
+  std::lock_guard<std::mutex> fileLock(fileMutex);
+  if( path.empty() )
+    return;
+  if( !fileValid )
+  {
+    // the entry is already published, so the snapshot contains it:
+    std::vector<Entry> snapshot;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      snapshot = entries;
+    }
+    fileValid = writeFile(snapshot);
+    return;
+  }
+
+  // unbuffered, such that the entry goes to the end of the file in one piece, even when another
+  // process appends at the same time:
+  FILE* file = fopen(path.c_str(), "ab");
+  if( file == NULL )
+    return;
+  setvbuf(file, NULL, _IONBF, 0);
+  bool ok = writeEntryData(file, entry);
+  ok = (fclose(file) == 0) && ok;
+  fileValid = ok; // after a failed write, the next store writes the file anew
+}
+
+bool MipMapCache::writeFile(const std::vector<Entry>& entriesToWrite)
+{
+  std::string tmpPath = path + ".tmp";
+  FILE* file = fopen(tmpPath.c_str(), "wb");
+  if( file == NULL )
+    return false;
+
+  FileHeader header;
+  memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+  header.version       = cacheVersion;
+  header.renderVersion = MipMappedWaveTable::renderVersion;
+  header.tableLength   = MipMappedWaveTable::tableLength;
+  header.numTables     = MipMappedWaveTable::numTables;
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+  for(size_t i=0; i<entriesToWrite.size() && ok; i++)
+    ok = writeEntryData(file, entriesToWrite[i]);
+  ok = (fclose(file) == 0) && ok;
+
+  // replace the old file - our mapping of it (if any) stays valid:
+  if( ok )
+  {
+#ifdef _WIN32
+    ok = MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    ok = rename(tmpPath.c_str(), path.c_str()) == 0;
+#endif
+  }
+  if( !ok )
+    remove(tmpPath.c_str()); // the cache is an optimization only, so we just don't persist
+  return ok;
+}
+
+bool MipMapCache::writeEntryData(FILE* file, const Entry& entry)
+{
+  // header and data in one buffer, written with a single call:
+  std::vector<char> buffer(sizeof(EntryHeader) + MipMappedWaveTable::mipMapSize*sizeof(double));
+  EntryHeader entryHeader;
+  memset(&entryHeader, 0, sizeof(entryHeader));
+  entryHeader.key              = entry.key;
+  entryHeader.waveform         = entry.parameters.waveform;
+  entryHeader.symmetry         = entry.parameters.symmetry;
+  entryHeader.tanhShaperFactor = entry.parameters.tanhShaperFactor;
+  entryHeader.tanhShaperOffset = entry.parameters.tanhShaperOffset;
+  entryHeader.squarePhaseShift = entry.parameters.squarePhaseShift;
+  entryHeader.checksum         = entry.checksum; // unchecked entries keep the one from the file
+  memcpy(&buffer[0], &entryHeader, sizeof(entryHeader));
+  memcpy(&buffer[sizeof(entryHeader)], entry.mipMap, 
+    MipMappedWaveTable::mipMapSize*sizeof(double));
+  return fwrite(&buffer[0], buffer.size(), 1, file) == 1;
+}
+
+void MipMapCache::unmapFile()
+{
+  if( mappedData == NULL )
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile(mappedData);
+  CloseHandle((HANDLE) mappingHandle);
+  mappingHandle = NULL;
+#else
+  munmap(mappedData, mappedSize);
+#endif
+  mappedData = NULL;
+  mappedSize = 0;
+}
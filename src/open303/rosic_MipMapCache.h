@@ -0,0 +1,126 @@
+#ifndef rosic_MipMapCache_h
+#define rosic_MipMapCache_h
+
+// standard-library includes:
+#include <stdio.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// rosic-indcludes:
+#include "rosic_MipMappedWaveTable.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a process-wide cache of rendered mip-maps for the built-in waveforms, keyed by a hash of
+  the MipMappedWaveTable::WaveformParameters. All tables with the same parameters share one
+  read-only copy of the mip-map, so only the first of them has to do the FFT work.
+
+  The cache can be backed by a file which is memory-mapped read-only by open(). Whenever a new
+  mip-map is stored, it is appended to the file, such that the next session finds it. The file 
+  starts with a header that holds a magic number, the version of the file format, the render 
+  version of MipMappedWaveTable and the table dimensions - if any of these don't match, or the 
+  file has a torn entry at the end, the file is ignored and written anew (via a temporary file that
+  replaces the old one) with the next stored mip-map. The checksum of an entry from the file is
+  checked the first time that find() hits it, so only the entries that are actually used are paged
+  in. Entries with a wrong checksum are dropped and the tables are rendered as usual.
+
+  The functions of this class lock a mutex, so don't call them on the audio thread. The file is
+  written under a separate mutex, such that lookups don't wait for file I/O.
+
+  */
+
+  class MipMapCache
+  {
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Returns the one and only instance. */
+    static MipMapCache& getInstance();
+
+    /** Destructor. Unmaps the file. */
+    ~MipMapCache();
+
+    //---------------------------------------------------------------------------------------------
+    // setup:
+
+    /** Maps the cache file at the given path and remembers the path for subsequent writes. A
+    missing or invalid file is not an error - it will be (re)created when the first mip-map is
+    stored. */
+    void open(const std::string& path);
+
+    //---------------------------------------------------------------------------------------------
+    // lookup/storage:
+
+    /** Returns the cached mip-map for the given parameters or NULL, if there is none. */
+    const double* find(const MipMappedWaveTable::WaveformParameters& p);
+
+    /** Stores a copy of the given mip-map under the given parameters and returns a pointer to the
+    shared copy (or NULL, when the cache is full). The returned data stays valid until the end of
+    the process. */
+    const double* store(const MipMappedWaveTable::WaveformParameters& p, const double* mipMap);
+
+    //=============================================================================================
+
+  protected:
+
+    /** Constructor. Protected because this is a singleton. */
+    MipMapCache();
+
+    struct Entry
+    {
+      unsigned long long key;
+      MipMappedWaveTable::WaveformParameters parameters;
+      const double* mipMap; // points into the mapped file or to one of our heap copies
+      unsigned long long checksum;
+      bool verified;        // the checksum has been checked (entries from the file are unchecked)
+    };
+
+    /** Returns the key for the given parameters. */
+    static unsigned long long getKey(const MipMappedWaveTable::WaveformParameters& p);
+
+    /** Returns a checksum for a mip-map. */
+    static unsigned long long getChecksum(const double* mipMap);
+
+    /** Writes the given (already published) entry to the file, if we have a path - appended,
+    when the file is valid, otherwise the file is written anew with all entries. */
+    void appendToFile(const Entry& entry);
+
+    /** Writes the given entries into a new file that replaces the old one. Returns true on
+    success. */
+    bool writeFile(const std::vector<Entry>& entriesToWrite);
+
+    /** Unmaps the file, if any. */
+    void unmapFile();
+
+    /** Writes the header and data of an entry. Returns true on success. */
+    static bool writeEntryData(FILE* file, const Entry& entry);
+
+    static const int maxNumEntries = 32;
+
+    // guarded by mutex:
+    std::vector<Entry>   entries;
+    std::vector<double*> heapCopies;
+    std::mutex           mutex;
+
+    // guarded by fileMutex (path is also set under mutex and only once):
+    std::string          path;
+    bool                 fileValid; // the file at path has our header and only whole entries
+    std::mutex           fileMutex;
+
+    // the mapping:
+    void*  mappedData;
+    size_t mappedSize;
+    void*  mappingHandle; // only used on windows
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_MipMapCache_h
@@ -1,29 +1,55 @@
 #include "rosic_MipMappedWaveTable.h"
+#include "rosic_WaveTableRebuildThread.h"
+#include "rosic_MipMapCache.h"
+#ifndef ROSIC_NO_BAKED_WAVETABLES
+#include "rosic_BakedWaveTables.h"
+#endif
+#include <thread>
 using namespace rosic;
 
+const double MipMappedWaveTable::silentMipMap[MipMappedWaveTable::mipMapSize] = { 0.0 };
+
 MipMappedWaveTable::MipMappedWaveTable()
 {
   // init member variables:
-  sampleRate = 44100.0;
-  waveform   = 0;
-  symmetry   = 0.5;
+  sampleRate            = 44100.0;
+  parameters.waveform   = 0;
+  parameters.symmetry   = 0.5;
 
   // initialize internal 'back-panel' parameters
-  tanhShaperFactor = dB2amp(36.9);
-  tanhShaperOffset = 4.37;
-  squarePhaseShift = 180.0;
+  parameters.tanhShaperFactor = dB2amp(36.9);
+  parameters.tanhShaperOffset = 4.37;
+  parameters.squarePhaseShift = 180.0;
 
   // set up the fourier-transformer:
   fourierTransformer.setBlockSize(tableLength);
 
   // initialize the buffers:
   initPrototypeTable();
-  initTableSet();
+  ownedMipMaps[0]  = NULL;
+  ownedMipMaps[1]  = NULL;
+  ownedMipMapTables[0] = 0;
+  ownedMipMapTables[1] = 0;
+  mipMap           = silentMipMap;
+  numMipMapTables  = numTables;
+  numTablesToRender = numTables;
+  readyMipMap      = NULL;
+  spareMipMaps[0]  = NULL;
+  spareMipMaps[1]  = NULL;
+  rebuildGeneration   = 0;
+  rebuildRetry        = false;
+  asynchronousRebuild = false;
+  rebuildDeferred     = false;
 }
 
 MipMappedWaveTable::~MipMappedWaveTable()
 {
+  // make sure that the rebuild thread is done with us before we free the buffers:
+  if( asynchronousRebuild )
+    WaveTableRebuildThread::getInstance().cancel(this);
 
+  for(int i=0; i<2; i++)
+    delete[] ownedMipMaps[i].load();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -31,36 +57,216 @@ MipMappedWaveTable::~MipMappedWaveTable()
 
 void MipMappedWaveTable::setWaveform(double* newWaveForm, int lengthInSamples)
 {
-  int i;
-  if( lengthInSamples == tableLength )
-  {
-    // just copy the values into the internal buffer, when the length of the passed table and the
-    // internal table match:
-    for( i=0; i<tableLength; i++ )
-      prototypeTable[i] = newWaveForm[i];
-  }
+  setUserWaveform(newWaveForm, lengthInSamples);
+  setWaveform(USER);
+}
+
+void MipMappedWaveTable::setUserWaveform(const double* samples, int lengthInSamples)
+{
+  std::lock_guard<std::mutex> lock(userWaveformMutex);
+  if( samples != NULL && lengthInSamples > 0 )
+    userWaveform.assign(samples, samples+lengthInSamples);
   else
-  {
-    // implement periodic sinc-interpolation here...
-  }
-  generateMipMap();
+    userWaveform.clear();
 }
 
 void MipMappedWaveTable::setWaveform(int newWaveform)
 {
-  if( (newWaveform >= 0) && (newWaveform != waveform) )
+  if( (newWaveform >= 0) && (newWaveform != parameters.waveform || newWaveform == USER) )
   {
-    waveform = newWaveform;
+    parameters.waveform = newWaveform;
     renderWaveform();
   }
 }
 
 void MipMappedWaveTable::setSymmetry(double newSymmetry)
 {
-  symmetry = newSymmetry;
+  parameters.symmetry = newSymmetry;
   renderWaveform();
 }
 
+void MipMappedWaveTable::setAsynchronousRebuild(bool shouldRebuildAsynchronously)
+{
+  if( shouldRebuildAsynchronously && !asynchronousRebuild )
+    WaveTableRebuildThread::getInstance().start();
+  else if( !shouldRebuildAsynchronously && asynchronousRebuild )
+  {
+    // wait for pending jobs and take over their result:
+    WaveTableRebuildThread::getInstance().cancel(this);
+    updateMipMap();
+  }
+  asynchronousRebuild = shouldRebuildAsynchronously;
+}
+
+void MipMappedWaveTable::setNumTablesToRender(int newNumTables)
+{
+  newNumTables = clip(newNumTables, 1, numTables);
+  if( newNumTables == numTablesToRender )
+    return;
+
+  numTablesToRender = newNumTables;
+
+  if( asynchronousRebuild )
+  {
+    // a job that the rebuild thread renders right now with the old number of tables is thrown 
+    // away when it is done, so it must be posted again (this replaces a waiting one):
+    rebuildGeneration++;
+    postRebuild();
+  }
+  else if( isOwnedMipMap(mipMap) )
+    renderWaveform(); // our own buffer has the wrong size now (the shared ones are complete)
+}
+
+//-------------------------------------------------------------------------------------------------
+// buffer exchange with the rebuild thread:
+
+bool MipMappedWaveTable::updateMipMap()
+{
+  if( rebuildRetry.exchange(false) )
+    rebuildDeferred = true;
+  if( rebuildDeferred )
+    postRebuild();
+
+  const double* newMipMap = readyMipMap.exchange(NULL);
+  if( newMipMap == NULL )
+    return false;
+
+  // the old buffer is not read anymore from now on, so the rebuild thread may render into it:
+  const double* oldMipMap = mipMap;
+  setFrontMipMap(newMipMap);
+  if( isOwnedMipMap(oldMipMap) )
+    releaseSpareMipMap(const_cast<double*>(oldMipMap));
+  return true;
+}
+
+void MipMappedWaveTable::postRebuild()
+{
+  rebuildDeferred = !WaveTableRebuildThread::getInstance().tryPost(this, parameters, 
+    numTablesToRender, rebuildGeneration.load());
+}
+
+double* MipMappedWaveTable::acquireSpareMipMap(int numTablesInBuffer)
+{
+  // a swap on the reading thread takes a few instructions, so this gives up soon (when a buffer 
+  // is not free by then, something else holds it and spinning longer won't help):
+  for(int attempt=0; attempt<1000; attempt++)
+  {
+    const double* buffer = NULL;
+    for(int i=0; i<2 && buffer==NULL; i++)
+      buffer = spareMipMaps[i].exchange(NULL);
+
+    // a finished buffer that was not yet swapped in is outdated by the job at hand:
+    if( buffer == NULL )
+    {
+      const double* ready = readyMipMap.exchange(NULL);
+      if( isOwnedMipMap(ready) )
+        buffer = ready;
+    }
+
+    // when we have got no buffer, we may allocate one for a slot that is still empty:
+    for(int i=0; i<2; i++)
+    {
+      if( ownedMipMaps[i].load() == buffer )
+        return getOwnedMipMap(i, numTablesInBuffer);
+    }
+
+    // the reading thread is in the middle of a swap and is about to return the old buffer:
+    std::this_thread::yield();
+  }
+  return NULL;
+}
+
+void MipMappedWaveTable::publishMipMap(const double* finishedMipMap)
+{
+  // a buffer of ours that was finished before but not picked up would be lost otherwise:
+  const double* supersededMipMap = readyMipMap.exchange(finishedMipMap);
+  if( isOwnedMipMap(supersededMipMap) && supersededMipMap != finishedMipMap )
+    releaseSpareMipMap(supersededMipMap);
+}
+
+void MipMappedWaveTable::releaseSpareMipMap(const double* spareMipMap)
+{
+  // there are only two buffers, so one of the slots is free:
+  double* buffer = const_cast<double*>(spareMipMap);
+  for(int i=0; i<2; i++)
+  {
+    double* expected = NULL;
+    if( spareMipMaps[i].compare_exchange_strong(expected, buffer) )
+      return;
+  }
+}
+
+double* MipMappedWaveTable::getWritableMipMap()
+{
+  if( mipMap == ownedMipMaps[1].load() )
+    return getOwnedMipMap(1, numTablesToRender);
+  return getOwnedMipMap(0, numTablesToRender);
+}
+
+double* MipMappedWaveTable::getOwnedMipMap(int slot, int numTablesInBuffer)
+{
+  double* buffer = ownedMipMaps[slot];
+  if( buffer != NULL && ownedMipMapTables[slot] == numTablesInBuffer )
+    return buffer;
+
+  delete[] buffer;
+  buffer = allocateMipMap(numTablesInBuffer);
+  ownedMipMapTables[slot] = numTablesInBuffer;
+  ownedMipMaps[slot]      = buffer;
+  return buffer;
+}
+
+void MipMappedWaveTable::setFrontMipMap(const double* newMipMap)
+{
+  mipMap          = newMipMap;
+  numMipMapTables = numTables;
+  for(int i=0; i<2; i++)
+  {
+    if( newMipMap == ownedMipMaps[i].load() )
+      numMipMapTables = ownedMipMapTables[i];
+  }
+}
+
+void MipMappedWaveTable::copyMipMap(const double* source, double* target, int numTablesToCopy)
+{
+  for(int i=0; i<numTablesToCopy*(tableLength+4); i++)
+    target[i] = source[i];
+}
+
+void MipMappedWaveTable::freeOwnedMipMaps()
+{
+  for(int i=0; i<2; i++)
+  {
+    delete[] ownedMipMaps[i].exchange(NULL);
+    spareMipMaps[i] = NULL;
+  }
+}
+
+const double* MipMappedWaveTable::getBakedMipMap(const WaveformParameters& p)
+{
+#ifndef ROSIC_NO_BAKED_WAVETABLES
+  if( bakedMipMapSize != mipMapSize )
+    return NULL;
+  for(int i=0; i<numBakedMipMaps; i++)
+  {
+    if( bakedMipMaps[i].parameters == p )
+      return bakedMipMaps[i].mipMap;
+  }
+#else
+  (void) p; // nothing is baked in
+#endif
+  return NULL;
+}
+
+double* MipMappedWaveTable::allocateMipMap(int numTablesToAllocate)
+{
+  int     size   = numTablesToAllocate*(tableLength+4);
+  double* buffer = new double[size];
+  for(int i=0; i<size; i++)
+    buffer[i] = 0.0;
+  return buffer;
+}
+
 //-------------------------------------------------------------------------------------------------
 // internal functions:
 
@@ -70,94 +276,202 @@ void MipMappedWaveTable::initPrototypeTable()
     prototypeTable[i] = 0.0;
 }
 
-void MipMappedWaveTable::initTableSet()
+void MipMappedWaveTable::renderUserPrototype(double* prototype)
 {
-  int t, i; // indices fo table and position
-  for(t=0; t<numTables; t++)
-    for(i=0; i<tableLength+4; i++)
-      tableSet[t][i] = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(userWaveformMutex);
+    if( userWaveform.empty() )
+    {
+      for(int i=0; i<tableLength; i++)
+        prototype[i] = 0.0;
+      return;
+    }
+    resamplePeriodic(&userWaveform[0], (int) userWaveform.size(), prototype);
+  }
+  removeDC(prototype);
+  normalize(prototype);
+}
+
+void MipMappedWaveTable::resamplePeriodic(const double* in, int inLength, double* out)
+{
+  int i, k;
+  if( inLength == tableLength )
+  {
+    for(i=0; i<tableLength; i++)
+      out[i] = in[i];
+    return;
+  }
+
+  // the harmonics that fit into both lengths (DC and Nyquist are left out):
+  int numHarmonics = (rmin(inLength, tableLength)-1) / 2;
+
+  // sines and cosines for one period at both lengths (all arguments are multiples of these):
+  std::vector<double> inCos(inLength), inSin(inLength), outCos(tableLength), outSin(tableLength);
+  for(i=0; i<inLength; i++)
+    sinCos(2.0*PI*i/inLength, &inSin[i], &inCos[i]);
+  for(i=0; i<tableLength; i++)
+    sinCos(2.0*PI*i/tableLength, &outSin[i], &outCos[i]);
+
+  for(i=0; i<tableLength; i++)
+    out[i] = 0.0;
+  for(k=1; k<=numHarmonics; k++)
+  {
+    // analyze:
+    double a = 0.0, b = 0.0;
+    int    phase = 0; // k*i mod inLength
+    for(i=0; i<inLength; i++)
+    {
+      a     += in[i] * inCos[phase];
+      b     += in[i] * inSin[phase];
+      phase += k;
+      if( phase >= inLength )
+        phase -= inLength;
+    }
+    a *= 2.0/inLength;
+    b *= 2.0/inLength;
+
+    // synthesize:
+    phase = 0;
+    for(i=0; i<tableLength; i++)
+    {
+      out[i] += a*outCos[phase] + b*outSin[phase];
+      phase  += k;
+      if( phase >= tableLength )
+        phase -= tableLength;
+    }
+  }
 }
 
-void MipMappedWaveTable::removeDC()
+void MipMappedWaveTable::removeDC(double* table)
 {
   // calculate DC-offset (= average value of the table):
   double dcOffset = 0.0;
   int i;
   for(i=0; i<tableLength; i++)
-    dcOffset += prototypeTable[i];
+    dcOffset += table[i];
   dcOffset = dcOffset / tableLength;
 
   // remove DC-Offset:
   for(i=0; i<tableLength; i++)
-    prototypeTable[i] -= dcOffset;
+    table[i] -= dcOffset;
 }
 
-void MipMappedWaveTable::normalize()
+void MipMappedWaveTable::normalize(double* table)
 {
   // find maximum:
   double max = 0.0;
   int    i;
   for(i=0; i<tableLength; i++)
-    if( fabs(prototypeTable[i]) > max)
-      max = fabs(prototypeTable[i]);
+    if( fabs(table[i]) > max)
+      max = fabs(table[i]);
 
   // normalize to amplitude 1.0:
+  if( max == 0.0 )
+    return;
   double scale = 1.0/max;
   for(i=0; i<tableLength; i++)
-    prototypeTable[i] *= scale;
+    table[i] *= scale;
 }
 
-void MipMappedWaveTable::reverseTime()
+void MipMappedWaveTable::reverseTime(double* table)
 {
   int    i;
   double tmpTable[tableLength+4];
 
   for(i=0; i<tableLength; i++)
-    tmpTable[i] = prototypeTable[tableLength-i-1];
+    tmpTable[i] = table[tableLength-i-1];
 
   for(i=0; i<tableLength; i++)
-    prototypeTable[i] = tmpTable[i];
+    table[i] = tmpTable[i];
 }
 
 void MipMappedWaveTable::renderWaveform()
 {
-  switch( waveform )
+  if( asynchronousRebuild )
+  {
+    postRebuild();
+    return;
+  }
+
+  // user waveforms are neither baked nor cached:
+  if( parameters.waveform == USER )
+  {
+    double* target = getWritableMipMap();
+    renderUserPrototype(prototypeTable);
+    generateMipMap(prototypeTable, target, &fourierTransformer, numTablesToRender);
+    setFrontMipMap(target);
+    return;
+  }
+
+  // use the baked or cached tables, if possible - render them otherwise:
+  const double* shared = getBakedMipMap(parameters);
+  if( shared != NULL )
+  {
+    setFrontMipMap(shared);
+    freeOwnedMipMaps();
+    return;
+  }
+  MipMapCache& cache = MipMapCache::getInstance();
+  shared = cache.find(parameters);
+  if( shared == NULL )
   {
-  case   SINE:      fillWithSine();        break;
-  case   TRIANGLE:  fillWithTriangle();    break;
-  case   SQUARE:    fillWithSquare();      break;
-  case   SAW:       fillWithSaw();         break;
-  case   SQUARE303: fillWithSquare303();   break;
-  case   SAW303:    fillWithSaw303();      break;
-
-  default :  fillWithSine();
+    // the cache serves all sample rates, so it gets all tables:
+    std::vector<double> completeMipMap(mipMapSize);
+    renderPrototype(parameters, prototypeTable);
+    generateMipMap(prototypeTable, &completeMipMap[0], &fourierTransformer);
+    shared = cache.store(parameters, &completeMipMap[0]);
+    if( shared == NULL )
+    {
+      // cache is full, keep our own copy:
+      double* target = getWritableMipMap();
+      copyMipMap(&completeMipMap[0], target, numTablesToRender);
+      setFrontMipMap(target);
+      return;
+    }
   }
+  setFrontMipMap(shared);
+  freeOwnedMipMaps();
 }
 
-void MipMappedWaveTable::generateMipMap()
+void MipMappedWaveTable::renderPrototype(const WaveformParameters& p, double* prototype)
 {
-  static double spectrum[tableLength];
-  //static int    position, offset;
-  static int t, i; // indices for the table and position
-
-  //position = 0;             // begin of the 1st table (index 0)
-  //offset   = tableLength+4; // offset between tow tables, the 4 is the number
-  // of additional samples used for interpolation
+  switch( p.waveform )
+  {
+  case   SINE:      fillWithSine(prototype);                 break;
+  case   TRIANGLE:  fillWithTriangle(prototype);             break;
+  case   SQUARE:    fillWithSquare(prototype, p.symmetry);   break;
+  case   SAW:       fillWithSaw(prototype, p.symmetry);      break;
+  case   SQUARE303: fillWithSquare303(prototype, p);         break;
+  case   SAW303:    fillWithSaw303(prototype);               break;
+
+  default :  fillWithSine(prototype);
+  }
+}
 
-  // copy the prototypeTable into the 1st table of the mipmap (this actually makes the
-  // prototypeTable redundant - room for optimization here):
-  t = 0;
+void MipMappedWaveTable::generateMipMap(double* prototype, double* targetMipMap,
+                                        FourierTransformerRadix2* transformer, 
+                                        int numTablesToGenerate)
+{
+  // this function may run on the rebuild thread and on other threads at the same time, so the 
+  // spectrum is a local buffer:
+  double spectrum[tableLength];
+  int t, i; // indices for the table and position
+  double* table;
+
+  // copy the prototype into the 1st table of the mipmap:
+  t     = 0;
+  table = targetMipMap;
   for(i=0; i<tableLength; i++)
-    tableSet[0][i] = prototypeTable[i];
+    table[i] = prototype[i];
 
   // additional sample(s) for the interpolator:
-  tableSet[t][tableLength]   = tableSet[t][0];
-  tableSet[t][tableLength+1] = tableSet[t][1];
-  tableSet[t][tableLength+2] = tableSet[t][2];
-  tableSet[t][tableLength+3] = tableSet[t][3];
+  table[tableLength]   = table[0];
+  table[tableLength+1] = table[1];
+  table[tableLength+2] = table[2];
+  table[tableLength+3] = table[3];
 
   // get the spectrum from the prototype-table:
-  fourierTransformer.transformRealSignal(prototypeTable, spectrum);
+  transformer->transformRealSignal(prototype, spectrum);
 
   // ensure that DC and Nyquist are zero:
   spectrum[0] = 0.0;
@@ -166,7 +480,7 @@ void MipMappedWaveTable::generateMipMap()
   // now, render the bandlimited versions by successively shrinking the
   // spectrum by one octave and iFFT'ing this spectrum:
   int lowBin, highBin;
-  for(t=1; t<numTables; t++)
+  for(t=1; t<numTablesToGenerate; t++)
   {
     lowBin  = (int) (tableLength / pow(2.0, t));   // the cutoff-bin
     highBin = (int) (tableLength / pow(2.0, t-1)); // the bin up to which the
@@ -177,56 +491,52 @@ void MipMappedWaveTable::generateMipMap()
       spectrum[i] = 0.0;
 
     // transform the truncated spectrum back to the time-domain and store it in
-    // the tableSet
-    fourierTransformer.transformSymmetricSpectrum(spectrum, tableSet[t]);
+    // the mip-map
+    table = targetMipMap + t*(tableLength+4);
+    transformer->transformSymmetricSpectrum(spectrum, table);
 
     // additional sample(s) for the interpolator:
-    tableSet[t][tableLength]   = tableSet[t][0];
-    tableSet[t][tableLength+1] = tableSet[t][1];
-    tableSet[t][tableLength+2] = tableSet[t][2];
-    tableSet[t][tableLength+3] = tableSet[t][3];
+    table[tableLength]   = table[0];
+    table[tableLength+1] = table[1];
+    table[tableLength+2] = table[2];
+    table[tableLength+3] = table[3];
   }
 }
 
 //-------------------------------------------------------------------------------------------------
 // fill the prototype-table with various standard waveforms:
 
-void MipMappedWaveTable::fillWithSine()
+void MipMappedWaveTable::fillWithSine(double* table)
 {
   for (long i=0; i<tableLength; i++)
-    prototypeTable[i] = sin( (2.0*PI*i) / (double) (tableLength) );
-  generateMipMap();
+    table[i] = sin( (2.0*PI*i) / (double) (tableLength) );
 }
 
-void MipMappedWaveTable::fillWithTriangle()
+void MipMappedWaveTable::fillWithTriangle(double* table)
 {
   int i;
   for (i=0; i<(tableLength/4); i++)
-    prototypeTable[i] = (double)(4*i) / (double)(tableLength);
+    table[i] = (double)(4*i) / (double)(tableLength);
 
   for (i=(tableLength/4); i<(3*tableLength/4); i++)
-    prototypeTable[i] = 2.0 - ((double)(4*i) / (double)(tableLength));
+    table[i] = 2.0 - ((double)(4*i) / (double)(tableLength));
 
   for (i=(3*tableLength/4); i<(tableLength); i++)
-    prototypeTable[i] = -4.0+ ((double)(4*i) / (double)(tableLength));
-
-  generateMipMap();
+    table[i] = -4.0+ ((double)(4*i) / (double)(tableLength));
 }
 
-void MipMappedWaveTable::fillWithSquare()
+void MipMappedWaveTable::fillWithSquare(double* table, double symmetry)
 {
   int    N  = tableLength;
   double k  = symmetry;
   int    N1 = clip(roundToInt(k*(N-1)), 1, N-1);
   for(int n=0; n<N1; n++)
-    prototypeTable[n] = +1.0;
+    table[n] = +1.0;
   for(int n=N1; n<N; n++)
-    prototypeTable[n] = -1.0;
-
-  generateMipMap();
+    table[n] = -1.0;
 }
 
-void MipMappedWaveTable::fillWithSaw()
+void MipMappedWaveTable::fillWithSaw(double* table, double symmetry)
 {
   int    N  = tableLength;
   double k  = symmetry;
@@ -235,14 +545,12 @@ void MipMappedWaveTable::fillWithSaw()
   double s1 = 1.0 / (N1-1);
   double s2 = 1.0 / N2;
   for(int n=0; n<N1; n++)
-    prototypeTable[n] = s1*n;
+    table[n] = s1*n;
   for(int n=N1; n<N; n++)
-    prototypeTable[n] = -1.0 + s2*(n-N1);
-
-  generateMipMap();
+    table[n] = -1.0 + s2*(n-N1);
 }
 
-void MipMappedWaveTable::fillWithSquare303()
+void MipMappedWaveTable::fillWithSquare303(double* table, const WaveformParameters& p)
 {
   // generate the saw-wave:
   int    N  = tableLength;
@@ -252,22 +560,20 @@ void MipMappedWaveTable::fillWithSquare303()
   double s1 = 1.0 / (N1-1);
   double s2 = 1.0 / N2;
   for(int n=0; n<N1; n++)
-    prototypeTable[n] = s1*n;
+    table[n] = s1*n;
   for(int n=N1; n<N; n++)
-    prototypeTable[n] = -1.0 + s2*(n-N1);
+    table[n] = -1.0 + s2*(n-N1);
 
   // switch polarity and apply tanh-shaping with dc-offset:
   for(int n=0; n<N; n++)
-    prototypeTable[n] = -tanh(tanhShaperFactor*prototypeTable[n] + tanhShaperOffset);
+    table[n] = -tanh(p.tanhShaperFactor*table[n] + p.tanhShaperOffset);
 
   // do a circular shift to phase-align with the saw-wave, when both waveforms are mixed:
-  int nShift = roundToInt(N*squarePhaseShift/360.0);
-  circularShift(prototypeTable, N, nShift);
-
-  generateMipMap();
+  int nShift = roundToInt(N*p.squarePhaseShift/360.0);
+  circularShift(table, N, nShift);
 }
 
-void MipMappedWaveTable::fillWithSaw303()
+void MipMappedWaveTable::fillWithSaw303(double* table)
 {
   // generate the saw-wave:
   int    N  = tableLength;
@@ -277,53 +583,47 @@ void MipMappedWaveTable::fillWithSaw303()
   double s1 = 1.0 / (N1-1);
   double s2 = 1.0 / N2;
   for(int n=0; n<N1; n++)
-    prototypeTable[n] = s1*n;
+    table[n] = s1*n;
   for(int n=N1; n<N; n++)
-    prototypeTable[n] = -1.0 + s2*(n-N1);
+    table[n] = -1.0 + s2*(n-N1);
 
   // switch polarity:
   //for(int n=0; n<N; n++)
-  //  prototypeTable[n] = -prototypeTable[n];
-
-  generateMipMap();
+  //  table[n] = -table[n];
 }
 
-void MipMappedWaveTable::fillWithPeak()
+void MipMappedWaveTable::fillWithPeak(double* table)
 {
   int i;
   for (i=0; i<(tableLength/2); i++)
-    prototypeTable[i] = 1 - (double)(2*i) / (double)(tableLength);
+    table[i] = 1 - (double)(2*i) / (double)(tableLength);
 
   for (i=(tableLength/2); i<(tableLength); i++)
-    prototypeTable[i] = 0.0;
-
-  removeDC();
-  normalize();
+    table[i] = 0.0;
 
-  generateMipMap();
+  removeDC(table);
+  normalize(table);
 }
 
-void MipMappedWaveTable::fillWithMoogSaw()
+void MipMappedWaveTable::fillWithMoogSaw(double* table)
 {
   // the sawUp part:
   int i;
   for (i=0; i<(tableLength/2); i++)
-    prototypeTable[i] = (double)(2*i) / (double)(tableLength);
+    table[i] = (double)(2*i) / (double)(tableLength);
 
   for (i=(tableLength/2); i<(tableLength); i++)
-    prototypeTable[i] = (double)(2*i) / (double)(tableLength) - 2.0;
+    table[i] = (double)(2*i) / (double)(tableLength) - 2.0;
 
   // the triangle part:
   for (i=0; i<(tableLength/2); i++)
-    prototypeTable[i] += 1 - (double)(4*i) / (double)(tableLength);
+    table[i] += 1 - (double)(4*i) / (double)(tableLength);
 
   for (i=(tableLength/2); i<tableLength; i++)
-    prototypeTable[i] += -1 + (double)(4*i) / (double)(tableLength);
-
-  removeDC();
-  normalize();
+    table[i] += -1 + (double)(4*i) / (double)(tableLength);
 
-  generateMipMap();
+  removeDC(table);
+  normalize(table);
 }
 
 
@@ -1,10 +1,26 @@
 #ifndef rosic_MipMappedWaveTable_h
 #define rosic_MipMappedWaveTable_h
 
+// standard-library includes:
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 // rosic-indcludes:
 #include "rosic_FunctionTemplates.h"
 #include "rosic_FourierTransformerRadix2.h"
 
+// The length of the tables is chosen at compile time (512 or 1024). The table for a given
+// frequency holds the same harmonics for both lengths, except for low notes where the full-band 
+// table is used: a table of length N can hold only N/2-1 harmonics, so shorter tables sound less 
+// bright in the bass. In return, they need half the memory - with cubic interpolation, tables of 
+// length 512 have an SNR of 51.5 dB for 128 harmonics, against 53.9 dB for tables of length 1024
+// with linear interpolation (measured with tools/InterpolationBenchmark.cpp). Length 256 is not
+// supported: even with cubic interpolation, it only reaches 29.8 dB.
+#ifndef ROSIC_WAVETABLE_LENGTH
+#define ROSIC_WAVETABLE_LENGTH 1024
+#endif
+
 namespace rosic
 {
 
@@ -13,6 +29,15 @@ namespace rosic
   This is a class for generating and storing a single-cycle-waveform in a lookup-table and 
   retrieving values form it at arbitrary positions by means of interpolation.
 
+  The bandlimited tables (the mip-map) are read through the pointer 'mipMap'. For the built-in
+  waveforms, it usually points to a read-only copy that is shared via the MipMapCache by all tables
+  with the same parameters, otherwise to one of our own heap buffers. When asynchronous rebuilding
+  is switched on, a change of the waveform parameters does not render the tables in place but posts
+  a job to the WaveTableRebuildThread, which renders into a spare buffer. The finished buffer is
+  picked up by calling updateMipMap() at a block boundary on the thread that also reads the table.
+  This swaps a pointer and hands the old buffer back as spare - so the reading thread never sees a
+  half-written table and never does FFT work itself.
+
   */
 
   class MipMappedWaveTable
@@ -23,6 +48,8 @@ namespace rosic
     friend class Oscillator;
     friend class BlendOscillator;
     friend class SuperOscillator;
+    friend class WaveTableRebuildThread;
+    friend class MipMapCache;
     // \ todo: get rid of this by providing get-functions
 
   public:
@@ -35,7 +62,33 @@ namespace rosic
       SQUARE,
       SAW,
       SQUARE303,
-      SAW303
+      SAW303,
+      USER     // the waveform passed to setUserWaveform
+    };
+
+    enum interpolationMethods
+    {
+      LINEAR = 0,
+      CUBIC_HERMITE, // 4-point, 3rd order Hermite (Catmull-Rom)
+      LAGRANGE       // 4-point, 3rd order Lagrange
+    };
+
+    /** Bundles all parameters that determine the content of the mip-map, such that a rebuild can
+    be handed over to another thread as a self-contained job. */
+    struct WaveformParameters
+    {
+      int    waveform;         // index of the chosen native waveform
+      double symmetry;         // symmetry between 1st and 2nd half-wave
+      double tanhShaperFactor; // drive for the tanh-shaper of the 303-square as raw factor
+      double tanhShaperOffset; // offset for the tanh-shaper of the 303-square
+      double squarePhaseShift; // phase shift of the 303-square with respect to the saw in degrees
+
+      bool operator==(const WaveformParameters& p) const
+      {
+        return waveform == p.waveform && symmetry == p.symmetry 
+          && tanhShaperFactor == p.tanhShaperFactor && tanhShaperOffset == p.tanhShaperOffset
+          && squarePhaseShift == p.squarePhaseShift;
+      }
     };
 
     //---------------------------------------------------------------------------------------------
@@ -57,48 +110,82 @@ namespace rosic
 
     /** Overloaded function to set the waveform form outside this class. This function expects a 
     pointer to the prototype-waveform to be handed over along with the length of this waveform. It 
-    copies the values into the internal buffers and renders various bandlimited version via 
-    FFT/iFFT.
-    \todo: Interpolation for the case that lengthInSamples does not match the length of the 
-    internal table-length. */
+    is a shorthand for setUserWaveform() followed by setWaveform(USER) - when asynchronous 
+    rebuilding is on, use these two functions instead to keep the resampling off the reading 
+    thread. */
     void setWaveform(double* newWaveform, int lengthInSamples);
 
+    /** Sets a single cycle of arbitrary length that is used when the waveform USER is selected. 
+    The samples are copied and later resampled to the table length with periodic band-limited 
+    interpolation, freed from DC and normalized. The new waveform takes effect with the next call 
+    to setWaveform(USER) - this re-renders the tables also when USER is already selected. Passing 
+    NULL or a length of zero clears the waveform (USER renders silence then). This function locks 
+    a mutex that is also locked by the rebuild thread, so when asynchronous rebuilding is on, don't
+    call it from the thread that reads from the table. */
+    void setUserWaveform(const double* samples, int lengthInSamples);
+
     /** Sets the time symmetry between the first and second half-wave (as value between 0...1) - 
     for a square wave, this is also known as pulse-width. Currently only implemented for square and 
     saw waveforms. */
     void setSymmetry(double newSymmetry);
 
+    /** Switches between rendering the tables synchronously inside the parameter setters (the
+    default) and posting the rendering to the WaveTableRebuildThread. In the latter case,
+    updateMipMap() must be called regularly by the thread that reads from the table. Switching
+    asynchronous rebuilding on starts the rebuild thread, so don't do it on the audio thread. */
+    void setAsynchronousRebuild(bool shouldRebuildAsynchronously);
+
+    /** Sets the number of bandlimited tables that our own buffers hold, counted from the full
+    bandwidth one. The oscillator sets this to the highest table it can reach at its sample rate, 
+    such that the more strongly bandlimited tables are neither rendered nor allocated for user 
+    waveforms (the shared mip-maps from the cache are always complete). Table indices beyond the 
+    range read the last rendered table. Must be called from the thread that reads the table - when
+    our own buffers are in use, they are re-rendered with the new number of tables. This doesn't 
+    block: with asynchronous rebuilding, a job that the rebuild thread may currently be rendering 
+    with the old number of tables is discarded when it is done (@see getRebuildGeneration). */
+    void setNumTablesToRender(int newNumTables);
+
     // internal 'back-panel' parameters:
 
     /** Sets the drive (in dB) for the tanh-shaper for 303-square waveform - internal parameter, to 
     be scrapped eventually. */
     void setTanhShaperDriveFor303Square(double newDrive)
-    { tanhShaperFactor = dB2amp(newDrive); fillWithSquare303(); }
+    { parameters.tanhShaperFactor = dB2amp(newDrive); renderWaveform(); }
 
     /** Sets the offset (as raw value for the tanh-shaper for 303-square waveform - internal 
     parameter, to be scrapped eventually. */
     void setTanhShaperOffsetFor303Square(double newOffset)
-    { tanhShaperOffset = newOffset; fillWithSquare303(); }
+    { parameters.tanhShaperOffset = newOffset; renderWaveform(); }
 
     /** Sets the phase shift of tanh-shaped square wave with respect to the saw-wave (in degrees)
     - this is important when the two are mixed. */
     void set303SquarePhaseShift(double newShift)
-    { squarePhaseShift = newShift; fillWithSquare303(); }
+    { parameters.squarePhaseShift = newShift; renderWaveform(); }
 
     //---------------------------------------------------------------------------------------------
     // inquiry:
 
     /** Returns the drive (in dB) for the tanh-shaper for 303-square waveform - internal parameter, to 
     be scrapped eventually. */
-    double getTanhShaperDriveFor303Square() const { return amp2dB(tanhShaperFactor); }
+    double getTanhShaperDriveFor303Square() const { return amp2dB(parameters.tanhShaperFactor); }
 
     /** Returns the offset (as raw value for the tanh-shaper for 303-square waveform - internal 
     parameter, to be scrapped eventually. */
-    double getTanhShaperOffsetFor303Square() const { return tanhShaperOffset; }
+    double getTanhShaperOffsetFor303Square() const { return parameters.tanhShaperOffset; }
 
     /** Returns the phase shift of tanh-shaped square wave with respect to the saw-wave (in degrees)
     - this is important when the two are mixed. */
-    double get303SquarePhaseShift() const { return squarePhaseShift; }
+    double get303SquarePhaseShift() const { return parameters.squarePhaseShift; }
+
+    /** Returns true when asynchronous rebuilding is switched on. */
+    bool isRebuildingAsynchronously() const { return asynchronousRebuild; }
+
+    /** Returns the number of tables that our own buffers hold. @see setNumTablesToRender */
+    int getNumTablesToRender() const { return numTablesToRender; }
+
+    /** Returns a counter that is incremented whenever the number of tables changes. Rebuild jobs
+    carry the generation at the time of posting, a job of an older generation is outdated. */
+    int getRebuildGeneration() const { return rebuildGeneration.load(); }
 
     //---------------------------------------------------------------------------------------------
     // audio processing:
@@ -114,93 +201,270 @@ namespace rosic
     internally. */
     INLINE double getValueLinear(double phaseIndex, int tableIndex);
 
+    /** Returns the value at position 'integerPart+fractionalPart' of table 'tableIndex' with 
+    4-point cubic Hermite interpolation. */
+    INLINE double getValueCubicHermite(int integerPart, double fractionalPart, int tableIndex);
+
+    /** Returns the value at position 'integerPart+fractionalPart' of table 'tableIndex' with 
+    4-point Lagrange interpolation. */
+    INLINE double getValueLagrange(int integerPart, double fractionalPart, int tableIndex);
+
+    /** Returns the value at position 'integerPart+fractionalPart' of table 'tableIndex' with the
+    interpolation method given as template parameter (@see interpolationMethods). */
+    template<int method>
+    INLINE double getValue(int integerPart, double fractionalPart, int tableIndex);
+
+    /** To be called at block boundaries by the thread that reads from the table when asynchronous
+    rebuilding is on. Re-posts a rebuild that could not be queued before and swaps in a finished
+    mip-map, if any. Returns true, when a new mip-map was swapped in. This function doesn't block
+    and doesn't allocate. */
+    bool updateMipMap();
+
   protected:
 
-    // functions to fill table with the built-in waveforms (these functions are
-    // called from setWaveform(int newWaveform):
-    void fillWithSine();
-    void fillWithTriangle();
-    void fillWithSquare();
-    void fillWithSaw();
-    void fillWithSquare303();
-    void fillWithSaw303();
-    void fillWithPeak();
-    void fillWithMoogSaw();
+    // functions to fill a prototype table with the built-in waveforms (these functions are
+    // called from renderPrototype):
+    static void fillWithSine(double* table);
+    static void fillWithTriangle(double* table);
+    static void fillWithSquare(double* table, double symmetry);
+    static void fillWithSaw(double* table, double symmetry);
+    static void fillWithSquare303(double* table, const WaveformParameters& p);
+    static void fillWithSaw303(double* table);
+    static void fillWithPeak(double* table);
+    static void fillWithMoogSaw(double* table);
 
     void initPrototypeTable();
       // fills the "prototypeTable"-variable with all zeros
 
-    void initTableSet();
-      // fills the "tableSet"-variable with all zeros
+    /** Renders the user waveform into the given prototype buffer (thread-safe). */
+    void renderUserPrototype(double* prototype);
 
-    void removeDC();
-      // removes dc-component from the waveform in the prototype-table
+    /** Resamples one period of a periodic signal to the table length by evaluating its Fourier 
+    series up to the highest harmonic that both lengths can represent. */
+    static void resamplePeriodic(const double* in, int inLength, double* out);
 
-    void normalize();
-      // normalizes the amplitude of the prototype-table to 1.0
+    static void removeDC(double* table);
+      // removes dc-component from the waveform in the table
 
-    void reverseTime();
-      // time-reverses the prototype-table
+    static void normalize(double* table);
+      // normalizes the amplitude of the table to 1.0
 
-    /** Renders the prototype waveform and generates the mip-map from that. */
+    static void reverseTime(double* table);
+      // time-reverses the table
+
+    /** Renders the prototype waveform and generates the mip-map from that - either right here or
+    via the rebuild thread. */
     void renderWaveform();
 
-    void generateMipMap();
-      // generates a multisample from the prototype table, where each of the
-      // successive tables contains one half of the spectrum of the previous one
+    /** Fills the prototype table with the waveform described by the parameters. */
+    static void renderPrototype(const WaveformParameters& p, double* prototype);
+
+    static void generateMipMap(double* prototype, double* targetMipMap,
+      FourierTransformerRadix2* transformer, int numTablesToGenerate = numTables);
+      // generates a multisample from the prototype table, where each of the successive tables
+      // contains one half of the spectrum of the previous one - only the first 
+      // numTablesToGenerate tables are written
+
+    /** Posts a rebuild job with the current parameters to the rebuild thread without blocking.
+    When the job queue is busy, the post is deferred to the next call to updateMipMap(). */
+    void postRebuild();
+
+    /** Called on the rebuild thread to obtain a buffer for the given number of tables to render 
+    into. This is either one of the spare buffers, a finished buffer that was not yet picked up 
+    (and is stale now anyway) or a freshly allocated one. Returns NULL when no buffer became free 
+    within a short time (the reading thread may be in the middle of a swap) - the job must then 
+    be given up with rebuildFailed(). */
+    double* acquireSpareMipMap(int numTablesInBuffer);
+
+    /** Called on the rebuild thread to hand over a finished mip-map - either one of our own
+    buffers or a shared one from the cache. A finished buffer of ours that was not yet picked up
+    goes back to the spare buffers. */
+    void publishMipMap(const double* finishedMipMap);
+
+    /** Called on the rebuild thread when a job could not be finished. The reading thread posts it
+    again on its next call to updateMipMap(). */
+    void rebuildFailed() { rebuildRetry = true; }
+
+    /** Gives one of our own buffers back to the pool of spare buffers. */
+    void releaseSpareMipMap(const double* spareMipMap);
+
+    /** Returns true, if the passed mip-map is one of our own buffers (as opposed to a shared one 
+    from the cache). */
+    bool isOwnedMipMap(const double* m) const
+    { return m != NULL && (m == ownedMipMaps[0].load() || m == ownedMipMaps[1].load()); }
+
+    /** Returns a buffer to render into synchronously. It holds numTablesToRender tables. */
+    double* getWritableMipMap();
+
+    /** Returns our own buffer in the given slot, (re)allocated for the given number of tables, if
+    necessary. The buffer must not be in use. */
+    double* getOwnedMipMap(int slot, int numTablesInBuffer);
+
+    /** Makes the given mip-map the one that is read from. */
+    void setFrontMipMap(const double* newMipMap);
 
-    static const int tableLength = 1024;
+    /** Copies the first tables of a complete mip-map into one of our own buffers. */
+    static void copyMipMap(const double* source, double* target, int numTablesToCopy);
+
+    /** Frees our own buffers - only allowed when they are not used and asynchronous rebuilding is
+    off. */
+    void freeOwnedMipMaps();
+
+    /** Returns the mip-map that was rendered at build time for the given parameters or NULL, if 
+    there is none (the defaults of SAW303 and SQUARE303 are baked in). */
+    static const double* getBakedMipMap(const WaveformParameters& p);
+
+    /** Allocates a zero-initialized buffer for the given number of tables. */
+    static double* allocateMipMap(int numTablesToAllocate);
+
+    static const int tableLength = ROSIC_WAVETABLE_LENGTH;
       // Length of the lookup-table. The actual length of the allocated memory is 4 samples longer, 
       // to store additional samples for the interpolator (which are the same values as at the 
       // beginning of the buffer) */
 
-
-    double symmetry; // symmetry between 1st and 2nd half-wave
-
     static const int numTables = 12;
       // The Oscillator class uses a one table-per octave multisampling to avoid aliasing. With a 
       // table-size of 8192 and a sample-sample rate of  44100, the 12th table will have a 
       // fundamental frequency (the frequency where the increment is 1) of 11025 which is good for 
       // the highest frequency. 
 
-    int    waveform;   // index of the currently chosen native waveform
-    double sampleRate; // the sampleRate
-
-    double prototypeTable[tableLength];
+    static const int mipMapSize = numTables*(tableLength+4);
+      // number of doubles in one complete mip-map
+
+    static const int renderVersion = 2;
+      // Version of the code that renders the mip-maps (renderPrototype, generateMipMap and the FFT
+      // they use). Increment it with every change that alters the rendered tables, such that
+      // mip-maps which were stored by an older version (e.g. in the MipMapCache file) are not used
+      // anymore.
+      // 2: FFT twiddle factors from the shared plan cache
+
+    /** Returns the table with the given index (clipped to the tables in the current mip-map). */
+    INLINE const double* getTable(int tableIndex) const;
+
+    /** Evaluates the 4-point interpolator with the given weights around position 'integerPart' of
+    the table - the first point is at integerPart-1, wrapped around at the start. */
+    INLINE static double interpolate4(const double* table, int integerPart, const double* weights);
+
+    // read for every sample - declared first, such that they share a cache line with the start of
+    // the object instead of sitting behind the prototype table:
+    const double* mipMap;
+      // The multisample for anti-aliased waveform generation, laid out as numTables tables of
+      // tableLength+4 values each. The 4 additional values are equal to the first 4 values in the
+      // table for easier interpolation. Table index 0 is the first version which has full
+      // bandwidth, index 1 accesses the second version which is bandlimited to Nyquist/2,
+      // 2->Nyquist/4, 3->Nyquist/8, etc. This is the buffer that is currently read from - it is
+      // only ever touched by the reading thread. Before any waveform is rendered, it points to a
+      // static mip-map of all zeros. */
+    int numMipMapTables;   // number of tables in mipMap - numTables unless it is one of our own
+
+    WaveformParameters parameters; // the parameters of the currently chosen waveform
+    double sampleRate;             // the sampleRate
+
+    std::vector<double> userWaveform;      // the samples passed to setUserWaveform
+    std::mutex          userWaveformMutex; // guards userWaveform
+
+    double prototypeTable[tableLength+4];
       // this is the prototype-table with full bandwidth. one additional sample (same as 
       // prototypeTable[0]) for linear interpolation without need for table wraparound at the last 
       // sample (-> saves one if-statement each audio-cycle) ...and a three further addtional 
       // samples for more elaborate interpolations like cubic (not implemented yet, also:
       // the fillWith...()-functions don't support these samples yet). */
 
-    double tableSet[numTables][tableLength+4];
-      // The multisample for anti-aliased waveform generation. The 4 additional values are equal 
-      // to the first 4 values in the table for easier interpolation. The first index is for the 
-      // table-number - index 0 accesses the first version which has full bandwidth, index 1 
-      // accesses the second version which is bandlimited to Nyquist/2, 2->Nyquist/4, 
-      // 3->Nyquist/8, etc. */
+    static const double silentMipMap[mipMapSize];
+      // What the tables read before any waveform is rendered.
+
+    int numTablesToRender; // number of tables in our own buffers
+
+    // buffer exchange with the rebuild thread:
+    std::atomic<double*>       ownedMipMaps[2]; // our own buffers, allocated on demand
+    std::atomic<int>           ownedMipMapTables[2]; // number of tables in these buffers
+    std::atomic<const double*> readyMipMap;     // finished by the rebuild thread, not swapped in
+    std::atomic<double*>       spareMipMaps[2]; // free to be rendered into by the rebuild thread
+    std::atomic<int>           rebuildGeneration; // incremented when numTablesToRender changes
+    std::atomic<bool>          rebuildRetry;    // the rebuild thread gave up a job
+    bool    asynchronousRebuild;          // flag to post rebuilds instead of rendering in place
+    bool    rebuildDeferred;              // a rebuild could not be posted and must be retried
 
     // embedded objects:
     FourierTransformerRadix2 fourierTransformer;
 
-    // internal parameters:
-    double tanhShaperFactor, tanhShaperOffset, squarePhaseShift;
-
   };
 
   //-----------------------------------------------------------------------------------------------
   // inlined functions:
     
-  INLINE double MipMappedWaveTable::getValueLinear(int integerPart, double fractionalPart, int tableIndex)
+  static_assert(ROSIC_WAVETABLE_LENGTH == 512 || ROSIC_WAVETABLE_LENGTH == 1024,
+    "ROSIC_WAVETABLE_LENGTH must be 512 or 1024");
+
+  INLINE const double* MipMappedWaveTable::getTable(int tableIndex) const
   {
     // ensure, that the table index is in the valid range:
     if( tableIndex<=0 )
       tableIndex = 0;
-    else if ( tableIndex>numTables )
-      tableIndex = 11;
+    else if ( tableIndex>=numMipMapTables )
+      tableIndex = numMipMapTables-1;
+
+    return mipMap + tableIndex*(tableLength+4);
+  }
 
-    return   (1.0-fractionalPart) * tableSet[tableIndex][integerPart] 
-           +      fractionalPart  * tableSet[tableIndex][integerPart+1];
+  INLINE double MipMappedWaveTable::getValueLinear(int integerPart, double fractionalPart, int tableIndex)
+  {
+    const double *table = getTable(tableIndex);
+    return   (1.0-fractionalPart) * table[integerPart]
+           +      fractionalPart  * table[integerPart+1];
+  }
+
+  INLINE double MipMappedWaveTable::interpolate4(const double* table, int integerPart, 
+                                                 const double* weights)
+  {
+    // the guard samples at the end cover the points to the right, the point to the left of the 
+    // first sample is the last one:
+    double y[4];
+    y[0] = integerPart > 0 ? table[integerPart-1] : table[tableLength-1];
+    y[1] = table[integerPart];
+    y[2] = table[integerPart+1];
+    y[3] = table[integerPart+2];
+    return (weights[0]*y[0] + weights[1]*y[1]) + (weights[2]*y[2] + weights[3]*y[3]);
+  }
+
+  INLINE double MipMappedWaveTable::getValueCubicHermite(int integerPart, double fractionalPart, 
+                                                         int tableIndex)
+  {
+    // the weights are written as independent polynomials, which shortens the dependency chain:
+    double f  = fractionalPart;
+    double f2 = f*f;
+    double w[4];
+    w[0] = f  * (-0.5 + f*( 1.0 - 0.5*f));
+    w[1] = f2 * (-2.5 + 1.5*f) + 1.0;
+    w[2] = f  * ( 0.5 + f*( 2.0 - 1.5*f));
+    w[3] = f2 * (-0.5 + 0.5*f);
+    return interpolate4(getTable(tableIndex), integerPart, w);
+  }
+
+  INLINE double MipMappedWaveTable::getValueLagrange(int integerPart, double fractionalPart, 
+                                                     int tableIndex)
+  {
+    double f  = fractionalPart;
+    double fp = f + 1.0;
+    double fm = f - 1.0;
+    double fmm = f - 2.0;
+    double w[4];
+    w[0] = (-1.0/6.0) * f  * fm * fmm;
+    w[1] =    0.5     * fp * fm * fmm;
+    w[2] =   -0.5     * fp * f  * fmm;
+    w[3] = ( 1.0/6.0) * fp * f  * fm;
+    return interpolate4(getTable(tableIndex), integerPart, w);
+  }
+
+  template<int method>
+  INLINE double MipMappedWaveTable::getValue(int integerPart, double fractionalPart, int tableIndex)
+  {
+    switch( method ) // resolved at compile time
+    {
+    case CUBIC_HERMITE: return getValueCubicHermite(integerPart, fractionalPart, tableIndex);
+    case LAGRANGE:      return getValueLagrange(    integerPart, fractionalPart, tableIndex);
+    default:            return getValueLinear(      integerPart, fractionalPart, tableIndex);
+    }
   }
 
   INLINE double MipMappedWaveTable::getValueLinear(double phaseIndex, int tableIndex)
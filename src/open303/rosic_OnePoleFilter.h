@@ -72,6 +72,10 @@ namespace rosic
     /** Returns the cutoff-frequency. */
     double getCutoff() const { return cutoff; }
 
+    /** Retrieves the filter coefficients (for combining them with other filters). */
+    void getCoefficients(double* outB0, double* outB1, double* outA1) const
+    { *outB0 = b0; *outB1 = b1; *outA1 = a1; }
+
     //---------------------------------------------------------------------------------------------
     // audio processing:
 
@@ -115,7 +119,7 @@ namespace rosic
   INLINE double OnePoleFilter::getSample(double in)
   {
     // calculate the output sample:
-    y1 = b0*in + b1*x1 + a1*y1 + TINY;
+    y1 = ANTI_DENORMAL(b0*in + b1*x1 + a1*y1);
 
     // update the buffer variables:
     x1 = in;
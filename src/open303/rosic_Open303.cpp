@@ -2,6 +2,14 @@
 
 using namespace rosic;
 
+namespace
+{
+  const double defaultPreFilterHighpassCutoff  = 44.486;
+  const double defaultPostFilterHighpassCutoff = 24.167;
+}
+
+const Open303::CommonCoefficientSets Open303::commonCoefficientSets;
+
 //-------------------------------------------------------------------------------------------------
 // construction/destruction:
 
@@ -30,6 +38,24 @@ Open303::Open303()
   slideToNextNote  = false;
   idle             = true;
   envModDirty      = false;
+  pitchSettled     = false;
+  instCutoff       = cutoff;
+  smoothedCutoff   = cutoff;
+  cutoffFactor     =     1.0;
+  envScalerInc     =     0.0;
+  envOffsetInc     =     0.0;
+  resonance        =     0.0;
+  smoothedResonance =    0.0;
+  resonanceInc     =     0.0;
+  smoothingLength  = 0;
+  rampCountDown    = 0;
+  rampParameters   = false;
+  instCutoffInc    =     0.0;
+  instAmp          =     0.0;
+  instAmpInc       =     0.0;
+  modulationInterval  = 1;
+  modulationCountDown = 0;
+  modulationJump      = true;
 
   setEnvMod(25.0);
 
@@ -56,22 +82,20 @@ Open303::Open303()
   rc1.setTimeConstant(0.0);
   rc2.setTimeConstant(15.0);
 
-  highpass1.setMode(OnePoleFilter::HIGHPASS);
-  highpass2.setMode(OnePoleFilter::HIGHPASS);
-  allpass.setMode(OnePoleFilter::ALLPASS);
-  notch.setMode(BiquadFilter::BANDREJECT);
+  // tweakables (allpass and notch are set up in computeFixedCoefficientSet):
+  preFilterHighpassCutoff  = defaultPreFilterHighpassCutoff;
+  postFilterHighpassCutoff = defaultPostFilterHighpassCutoff;
 
   setSampleRate(sampleRate);
 
   // tweakables:
   oscillator.setPulseWidth(50.0);
-  highpass1.setCutoff(44.486);
-  highpass2.setCutoff(24.167);
-  allpass.setCutoff(14.008);
-  notch.setFrequency(7.5164);
-  notch.setBandwidth(4.7);
 
   filter.setFeedbackHighpassCutoff(150.0);
+
+  // from now on, waveform changes must not stall the thread that calls getSample:
+  waveTable1.setAsynchronousRebuild(true);
+  waveTable2.setAsynchronousRebuild(true);
 }
 
 Open303::~Open303()
@@ -84,33 +108,76 @@ Open303::~Open303()
 
 void Open303::setSampleRate(double newSampleRate)
 {
-  mainEnv.setSampleRate         (       newSampleRate);
-  ampEnv.setSampleRate          (       newSampleRate);
-  pitchSlewLimiter.setSampleRate((float)newSampleRate);
-  ampDeClicker.setSampleRate(    (float)newSampleRate);
-  rc1.setSampleRate(             (float)newSampleRate);
-  rc2.setSampleRate(             (float)newSampleRate);
+  if( newSampleRate > 0.0 )
+    sampleRate = newSampleRate;
+  updateModulationSampleRate();
+  pitchSlewLimiter.setSampleRate((float)sampleRate);
+
+  updateFixedFilters();
+
+  oscillator.setSampleRate    (  oversampling*sampleRate);
+  filter.setSampleRate        (  oversampling*sampleRate);
+}
+
+void Open303::setPreFilterHighpass(double newCutoff)
+{
+  preFilterHighpassCutoff = newCutoff;
+  updateFixedFilters();
+}
 
-  highpass2.setSampleRate     (         newSampleRate);
-  allpass.setSampleRate       (         newSampleRate);
-  notch.setSampleRate         (         newSampleRate);
+void Open303::setPostFilterHighpass(double newCutoff)
+{
+  postFilterHighpassCutoff = newCutoff;
+  updateFixedFilters();
+}
 
-  highpass1.setSampleRate     (  oversampling*newSampleRate);
+void Open303::setModulationInterval(int newInterval)
+{
+  newInterval = clip(newInterval, 1, 16);
+  if( newInterval == modulationInterval )
+    return;
+  modulationInterval  = newInterval;
+  modulationCountDown = 0;
+  updateModulationSampleRate();
+}
 
-  oscillator.setSampleRate    (  oversampling*newSampleRate);
-  filter.setSampleRate        (  oversampling*newSampleRate);
+void Open303::setParameterSmoothing(int numSamples)
+{
+  smoothingLength = rmax(numSamples, 0);
+  if( smoothingLength == 0 && rampCountDown > 0 )
+  {
+    envModDirty    = true; // let a running ramp arrive at the next update
+    rampParameters = false;
+  }
 }
 
 void Open303::setCutoff(double newCutoff)
 {
   cutoff = newCutoff;
-  envModDirty = true;
+  envModDirty    = true;
+  rampParameters = smoothingLength > 0 && !idle;
+}
+
+void Open303::setResonance(double newResonance, bool updateCoefficients)
+{
+  resonance = newResonance;
+  if( smoothingLength > 0 && !idle )
+  {
+    envModDirty    = true;
+    rampParameters = true;
+  }
+  else
+  {
+    smoothedResonance = newResonance;
+    filter.setResonance(newResonance, updateCoefficients);
+  }
 }
 
 void Open303::setEnvMod(double newEnvMod)
 {
   envMod = newEnvMod;
-  envModDirty = true;
+  envModDirty    = true;
+  rampParameters = smoothingLength > 0 && !idle;
 }
 
 void Open303::setAccent(double newAccent)
@@ -133,9 +200,105 @@ void Open303::setSlideTime(double newSlideTime)
   }
 }
 
+void Open303::updateWaveTables()
+{
+  if( waveTable1.updateMipMap() )
+    profiler.count(Profiler::WAVETABLE_REBUILDS);
+  if( waveTable2.updateMipMap() )
+    profiler.count(Profiler::WAVETABLE_REBUILDS);
+}
+
 void Open303::setPitchBend(double newPitchBend)
 {
   pitchWheelFactor = pitchOffsetToFreqFactor(newPitchBend);
+  pitchSettled     = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void Open303::processBlock(double* out, int numSamples)
+{
+  if( numSamples <= 0 )
+    return;
+  profiler.countSamples(numSamples);
+  if( idle )
+  {
+    for(int n=0; n<numSamples; n++)
+      out[n] = 0.0;
+    return;
+  }
+
+  switch( oscillator.getKernel() )
+  {
+  case 0:  processBlockWithKernel<0>(out, numSamples); break;
+  case 1:  processBlockWithKernel<1>(out, numSamples); break;
+  case 2:  processBlockWithKernel<2>(out, numSamples); break;
+  case 3:  processBlockWithKernel<3>(out, numSamples); break;
+  case 4:  processBlockWithKernel<4>(out, numSamples); break;
+  case 5:  processBlockWithKernel<5>(out, numSamples); break;
+  case 6:  processBlockWithKernel<6>(out, numSamples); break;
+  case 7:  processBlockWithKernel<7>(out, numSamples); break;
+  default: processBlockWithKernel<8>(out, numSamples);
+  }
+}
+
+template<int oscillatorKernel>
+void Open303::processBlockWithKernel(double* out, int numSamples)
+{
+  double amp[maxSubBlockSize];
+  double mainEnvOut[maxSubBlockSize], rc1Out[maxSubBlockSize], rc2Out[maxSubBlockSize];
+  double ampEnvOut[maxSubBlockSize];
+  double *end = out + numSamples;
+  profiler.start();
+  while( out < end )
+  {
+    int n = rmin((int)(end-out), maxSubBlockSize);
+
+    // the envelopes and RCs don't depend on anything that changes within the block, so they are
+    // rendered ahead for all modulation updates that fall into this sub-block:
+    int numUpdates = 0;
+    if( modulationCountDown < n )
+      numUpdates = (n-1-modulationCountDown) / modulationInterval + 1;
+    if( numUpdates > 0 )
+    {
+      mainEnv.renderBlock(mainEnvOut, numUpdates);
+      rc1.renderBlock(mainEnvOut, rc1Out, numUpdates);
+      if( accentGain > 0.0 )
+        rc2.renderBlock(mainEnvOut, rc2Out, numUpdates);
+      else
+      {
+        for(int i=0; i<numUpdates; i++)
+          rc2Out[i] = 0.0;
+        rc2.renderBlock(rc2Out, rc2Out, numUpdates);
+      }
+      ampEnv.renderBlock(ampEnvOut, numUpdates);
+    }
+
+    int u = 0;
+    for(int i=0; i<n; i++)
+    {
+      advancePitch();
+      if( modulationCountDown == 0 )
+      {
+        updateModulation(mainEnvOut[u], rc1Out[u], rc2Out[u], ampEnvOut[u]);
+        u++;
+      }
+      amp[i] = advanceInterpolation();
+      out[i] = getOversampledSample<oscillatorKernel>();
+    }
+    postFilter.processBlock(out, out, n); // allpass, highpass and notch
+    for(int i=0; i<n; i++)
+    {
+      out[i] *= amp[i];
+      out[i] *= ampScaler;
+    }
+    profiler.lap(Profiler::POST_CHAIN);
+    out += n;
+  }
+
+  // find out whether we may switch ourselves off for the next call:
+  idle = ampEnv.endIsReached() && fabs(end[-1]) < 0.000001;
 }
 
 //------------------------------------------------------------------------------------------------------------
@@ -193,11 +356,11 @@ void Open303::triggerNote(int noteNumber, bool hasAccent)
     oscillator.resetPhase();
     filter.reset();
     highpass1.reset();
-    highpass2.reset();
-    allpass.reset();
-    notch.reset();
+    postFilter.reset();
     //antiAliasFilter.reset();
     ampDeClicker.reset();
+    if( rampParameters || rampCountDown > 0 )
+      jumpToParameterTargets(); // don't let a new note sweep in from the old settings
   }
 
   if( hasAccent )
@@ -215,14 +378,18 @@ void Open303::triggerNote(int noteNumber, bool hasAccent)
 
   oscFreq = pitchToFreq(noteNumber, tuning);
   pitchSlewLimiter.setState(oscFreq);
+  pitchSettled = false;
   mainEnv.trigger();
   ampEnv.noteOn(true);
+  modulationCountDown = 0; // evaluate the envelopes right away
+  modulationJump      = true;
   idle = false;
 }
 
 void Open303::slideToNote(int noteNumber, bool hasAccent)
 {
-  oscFreq = pitchToFreq(noteNumber, tuning);
+  oscFreq      = pitchToFreq(noteNumber, tuning);
+  pitchSettled = false;
 
   if( hasAccent )
   {
@@ -251,7 +418,8 @@ void Open303::releaseNote(int noteNumber)
   else
   {
     // initiate slide back:
-    oscFreq     = pitchToFreq(currentNote);
+    oscFreq      = pitchToFreq(currentNote, tuning);
+    pitchSettled = false;
   }
 }
 
@@ -297,16 +465,134 @@ void Open303::calculateEnvModScalerAndOffset()
   }
 }
 
+void Open303::startParameterRamp()
+{
+  // calculateEnvModScalerAndOffset works on the targets, so we retrieve the target values with it
+  // and restore the current ones:
+  double oldScaler = envScaler;
+  double oldOffset = envOffset;
+  calculateEnvModScalerAndOffset();
+
+  rampCountDown = rmax(smoothingLength/modulationInterval, 1);
+  double scaler = 1.0 / rampCountDown;
+  cutoffFactor  = pow(cutoff/smoothedCutoff, scaler);
+  envScalerInc  = scaler * (envScaler - oldScaler);
+  envOffsetInc  = scaler * (envOffset - oldOffset);
+  resonanceInc  = scaler * (resonance - smoothedResonance);
+  envScaler     = oldScaler;
+  envOffset     = oldOffset;
+}
+
+void Open303::jumpToParameterTargets()
+{
+  smoothedCutoff = cutoff;
+  calculateEnvModScalerAndOffset();
+  smoothedResonance = resonance;
+  filter.setResonance(resonance, true);
+  rampCountDown  = 0;
+  rampParameters = false;
+  envModDirty    = false;
+}
+
+void Open303::updateModulationSampleRate()
+{
+  double modulationRate = sampleRate / modulationInterval;
+  mainEnv.setSampleRate         (       modulationRate);
+  ampEnv.setSampleRate          (       modulationRate);
+  ampDeClicker.setSampleRate(    (float)modulationRate);
+  rc1.setSampleRate(             (float)modulationRate);
+  rc2.setSampleRate(             (float)modulationRate);
+}
+
+void Open303::updateFixedFilters()
+{
+  const FixedCoefficientSet* set = NULL;
+  for(int i=0; i<CommonCoefficientSets::numSets; i++)
+  {
+    const FixedCoefficientSet& common = commonCoefficientSets.sets[i];
+    if(    common.sampleRate               == sampleRate
+        && common.preFilterHighpassCutoff  == preFilterHighpassCutoff
+        && common.postFilterHighpassCutoff == postFilterHighpassCutoff )
+    {
+      set = &common;
+      break;
+    }
+  }
+
+  FixedCoefficientSet computed;
+  if( set == NULL )
+  {
+    computed.sampleRate               = sampleRate;
+    computed.preFilterHighpassCutoff  = preFilterHighpassCutoff;
+    computed.postFilterHighpassCutoff = postFilterHighpassCutoff;
+    computeFixedCoefficientSet(computed);
+    set = &computed;
+  }
+
+  highpass1.setCoefficients(set->highpass1[0], set->highpass1[1], set->highpass1[2]);
+  postFilter.setNumStages(2);
+  for(int i=0; i<2; i++)
+  {
+    const double* c = set->postFilter[i];
+    postFilter.setStageCoefficients(i, c[0], c[1], c[2], c[3], c[4]);
+  }
+}
+
+void Open303::computeFixedCoefficientSet(FixedCoefficientSet& set)
+{
+  OnePoleFilter highpass1, highpass2, allpass;
+  BiquadFilter  notch;
+
+  highpass1.setSampleRate(oversampling*set.sampleRate);
+  highpass1.setMode(OnePoleFilter::HIGHPASS);
+  highpass1.setCutoff(set.preFilterHighpassCutoff);
+  highpass1.getCoefficients(&set.highpass1[0], &set.highpass1[1], &set.highpass1[2]);
+
+  highpass2.setSampleRate(set.sampleRate);
+  highpass2.setMode(OnePoleFilter::HIGHPASS);
+  highpass2.setCutoff(set.postFilterHighpassCutoff);
+  allpass.setSampleRate(set.sampleRate);
+  allpass.setMode(OnePoleFilter::ALLPASS);
+  allpass.setCutoff(14.008);
+  notch.setSampleRate(set.sampleRate);
+  notch.setMode(BiquadFilter::BANDREJECT);
+  notch.setFrequency(7.5164);
+  notch.setBandwidth(4.7);
+
+  // the allpass and the highpass share the first stage, the notch is the second:
+  double b0A, b1A, a1A, b0B, b1B, a1B;
+  allpass.getCoefficients(&b0A, &b1A, &a1A);
+  highpass2.getCoefficients(&b0B, &b1B, &a1B);
+  BiquadCascade cascade;
+  cascade.setStageFromFirstOrderPair(0, b0A, b1A, a1A, b0B, b1B, a1B);
+  double* c = set.postFilter[0];
+  cascade.getStageCoefficients(0, &c[0], &c[1], &c[2], &c[3], &c[4]);
+  c = set.postFilter[1];
+  notch.getCoefficients(&c[0], &c[1], &c[2], &c[3], &c[4]);
+}
+
+Open303::CommonCoefficientSets::CommonCoefficientSets()
+{
+  static const double sampleRates[numSets] = { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+  for(int i=0; i<numSets; i++)
+  {
+    sets[i].sampleRate               = sampleRates[i];
+    sets[i].preFilterHighpassCutoff  = defaultPreFilterHighpassCutoff;
+    sets[i].postFilterHighpassCutoff = defaultPostFilterHighpassCutoff;
+    computeFixedCoefficientSet(sets[i]);
+  }
+}
+
 void Open303::updateNormalizer1()
 {
   n1 = LeakyIntegrator::getNormalizer(mainEnv.getDecayTimeConstant(), rc1.getTimeConstant(),
-    sampleRate);
+    sampleRate/modulationInterval);
   n1 = 1.0; // test
 }
 
 void Open303::updateNormalizer2()
 {
   n2 = LeakyIntegrator::getNormalizer(mainEnv.getDecayTimeConstant(), rc2.getTimeConstant(),
-    sampleRate);
+    sampleRate/modulationInterval);
   n2 = 1.0; // test
 }
@@ -4,10 +4,12 @@
 #include "rosic_MidiNoteEvent.h"
 #include "rosic_BlendOscillator.h"
 #include "rosic_BiquadFilter.h"
+#include "rosic_BiquadCascade.h"
 #include "rosic_TeeBeeFilter.h"
 #include "rosic_AnalogEnvelope.h"
 #include "rosic_DecayEnvelope.h"
 #include "rosic_LeakyIntegrator.h"
+#include "rosic_Profiler.h"
 //#include "rosic_EllipticQuarterBandFilter.h"
 
 #include <list>
@@ -43,6 +45,8 @@ namespace rosic
         // 2. Trigger Envelopes (So it plays even if staccato)
         mainEnv.trigger();
         ampEnv.noteOn(true);
+        modulationCountDown = 0; // evaluate the envelopes right away
+        modulationJump      = true;
         
         // 3. Update Note List (Manually add note since we bypassed standard noteOn)
         currentNote = noteNumber;
@@ -66,6 +70,20 @@ namespace rosic
     /** Sets the sample-rate (in Hz). */
     void setSampleRate(double newSampleRate);
 
+    /** Sets the number of samples after which the modulation chain (filter and amp envelopes, 
+    envelope-to-cutoff mapping and amp declicker) is evaluated again (1...16). In between, the 
+    cutoff frequency and amplitude are interpolated linearly towards the most recently evaluated 
+    values, so they lag by up to that many samples. Note triggers force an evaluation. The default 
+    of 1 evaluates the chain for every sample. */
+    void setModulationInterval(int newInterval);
+
+    /** Sets the number of samples over which changes of cutoff, resonance and envelope modulation 
+    are ramped while a note is sounding, such that they may be sent at a low control rate without 
+    zipper noise. The cutoff is ramped exponentially (i.e. linearly in pitch), the others linearly.
+    The ramps advance with the modulation chain, so their length is rounded down to a multiple of 
+    the modulation interval. The default of 0 applies changes immediately. */
+    void setParameterSmoothing(int numSamples);
+
     /** Sets up the waveform continuously between saw and square - the input should be in the range 
     0...1 where 0 means pure saw and 1 means pure square. */
     void setWaveform(double newWaveform) { oscillator.setBlendFactor(newWaveform); }
@@ -77,7 +95,7 @@ namespace rosic
     void setCutoff(double newCutoff); 
 
     /** Sets the resonance amount for the filter. */
-    void setResonance(double newResonance, bool updateCoefficients = true) { filter.setResonance(newResonance, updateCoefficients); }
+    void setResonance(double newResonance, bool updateCoefficients = true);
 
     /** Sets the modulation depth of the filter's cutoff frequency by the filter-envelope generator 
     (in percent). */
@@ -112,13 +130,13 @@ namespace rosic
     { waveTable2.setTanhShaperOffsetFor303Square(newOffset); }
 
     /** Sets the cutoff frequency for the highpass before the main filter. */
-    void setPreFilterHighpass(double newCutoff) { highpass1.setCutoff(newCutoff); }
+    void setPreFilterHighpass(double newCutoff);
 
     /** Sets the cutoff frequency for the highpass inside the feedback loop of the main filter. */
     void setFeedbackHighpass(double newCutoff) { filter.setFeedbackHighpassCutoff(newCutoff); }
 
     /** Sets the cutoff frequency for the highpass after the main filter. */
-    void setPostFilterHighpass(double newCutoff) { highpass2.setCutoff(newCutoff); }
+    void setPostFilterHighpass(double newCutoff);
 
     /** Sets the phase shift of tanh-shaped square wave with respect to the saw-wave (in degrees)
     - this is important when the two are mixed. */
@@ -175,7 +193,7 @@ namespace rosic
     double getCutoff() const { return cutoff; }
 
     /** Returns the filter's resonance amount (in percent) */
-    double getResonance() const { return filter.getResonance(); }
+    double getResonance() const { return resonance; }
 
     /** Returns the modulation depth of the filter's cutoff frequency by the filter-envelope 
     generator (in percent). */
@@ -206,14 +224,14 @@ namespace rosic
     { return waveTable2.getTanhShaperOffsetFor303Square(); }
 
     /** Returns the cutoff frequency for the highpass before the main filter. */
-    double getPreFilterHighpass() const { return highpass1.getCutoff(); }
+    double getPreFilterHighpass() const { return preFilterHighpassCutoff; }
 
     /** Retruns the cutoff frequency for the highpass inside the feedback loop of the main 
     filter. */
     double getFeedbackHighpass() const { return filter.getFeedbackHighpassCutoff(); }
 
     /** Returns the cutoff frequency for the highpass after the main filter. */
-    double getPostFilterHighpass() const { return highpass2.getCutoff(); }
+    double getPostFilterHighpass() const { return postFilterHighpassCutoff; }
 
     /** Returns the phase shift of tanh-shaped square wave with respect to the saw-wave (in degrees)
     - this is important when the two are mixed. */
@@ -237,12 +255,36 @@ namespace rosic
     /** Returns the amplitudes envelope's release time (in milliseconds). */
     double getAmpRelease() const { return normalAmpRelease; }
 
+    /** Returns the number of samples between evaluations of the modulation chain. */
+    int getModulationInterval() const { return modulationInterval; }
+
+    /** Returns the number of samples over which parameter changes are ramped. */
+    int getParameterSmoothing() const { return smoothingLength; }
+
+    /** Returns true when the voice has fallen silent after the last note, such that getSample 
+    returns zero without doing anything until the next note is triggered. */
+    bool isIdle() const { return idle; }
+
     //-----------------------------------------------------------------------------------------------
     // audio processing:
 
     /** Calculates onse output sample at a time. */
     double getSample(); 
 
+    /** Calculates a block of output samples at once, which is faster than calling getSample 
+    numSamples times (the oscillator kernel is chosen once, the envelopes and RCs of the 
+    modulation chain are rendered ahead for all updates within a sub-block and the post-filter runs
+    over the whole block). The output is the same up to rounding, except that the check whether the
+    voice has fallen silent is done only at the end of the block, so a block may end in a tail 
+    below -120 dB where getSample would already return zeros. Events are applied between blocks - 
+    to place one within a block, split the block there. tools/ProcessBlockTest.cpp checks this 
+    (make test). */
+    void processBlock(double* out, int numSamples);
+
+    /** Picks up wavetables that were re-rendered in the background after a change of the 
+    waveform parameters (pulse width, tanh-shaper, etc.). Call this at block boundaries. */
+    void updateWaveTables();
+
     //-----------------------------------------------------------------------------------------------
     // event handling:
 
@@ -261,22 +303,68 @@ namespace rosic
 
      //
 
+    //-----------------------------------------------------------------------------------------------
+    // per-sample state:
+
+  protected:
+
+    // The data members are laid out in the order of how often getSample() touches them: first 
+    // the scalars that it reads or writes on every call (two cache lines), then the embedded 
+    // objects of the signal path in processing order, then the objects that are only touched on 
+    // parameter changes and at the very end (in the protected section further down) the 
+    // parameters themselves. Whether this order saves cache misses is unverified: it was not
+    // measured with hardware counters, and the timings of InstanceBenchmark show no consistent
+    // gain (a few percent slower at 64 and 4096 voices).
+
+    double instCutoff;       // interpolated cutoff frequency between modulation updates
+    double instCutoffInc;    // increment for instCutoff per sample
+    double instAmp;          // interpolated amplitude between modulation updates
+    double instAmpInc;       // increment for instAmp per sample
+    double ampScaler;        // final volume as raw factor
+    double oscFreq;          // frequecy of the oscillator (without pitchbend)
+    double pitchWheelFactor; // scale factor for oscillator frequency from pitch-wheel
+    double cutoff;           // nominal cutoff frequency of the filter
+    double smoothedCutoff;   // nominal cutoff on its way to cutoff
+    double envOffset;        // offset for the normalized envelope ('bipolarity' parameter)
+    double envScaler;        // scale-factor for the normalized envelope (derived from envMod)
+    double accentGain;       // between 0.0...1.0 - to scale the 3rd amp-envelope on accents
+    double n1, n2;           // normalizers for the RCs that are driven by the MEG
+    int    modulationInterval;  // number of samples between evaluations of the modulation chain
+    int    modulationCountDown; // samples until the next evaluation
+    int    rampCountDown;    // modulation updates until the parameter ramps have arrived
+    bool   idle;             // flag to indicate that we have currently nothing to do in getSample
+    bool   envModDirty;      // flag to defer calculateEnvModScalerAndOffset to getSample
+    bool   rampParameters;   // the deferred parameter change is to be ramped
+    bool   pitchSettled;     // slew limiter has converged, oscillator increment is up to date
+    bool   modulationJump;   // next modulation update starts a note - jump instead of interpolating
+
+  public:
+
     //-----------------------------------------------------------------------------------------------
     // embedded objects: 
 
-    MipMappedWaveTable        waveTable1, waveTable2;
+    // signal path, in processing order:
+    LeakyIntegrator           pitchSlewLimiter;
     BlendOscillator           oscillator;
+    OnePoleFilter             highpass1;
     TeeBeeFilter              filter;
-    AnalogEnvelope            ampEnv; 
+    BiquadCascade             postFilter; // allpass, post-filter highpass and notch
+
+    // modulation chain:
     DecayEnvelope             mainEnv;
-    LeakyIntegrator           pitchSlewLimiter;
+    LeakyIntegrator           rc1, rc2;
+    AnalogEnvelope            ampEnv; 
     //LeakyIntegrator           ampDeClicker;
     BiquadFilter              ampDeClicker;
-    LeakyIntegrator           rc1, rc2;
-    OnePoleFilter             highpass1, highpass2, allpass; 
-    BiquadFilter              notch;
     //EllipticQuarterBandFilter antiAliasFilter;
 
+    // only touched on waveform changes (the mip-maps themselves are allocated elsewhere):
+    MipMappedWaveTable        waveTable1, waveTable2;
+
+    // time spent in the stages of getSample and processBlock (empty unless ROSIC_PROFILE is 
+    // defined, the caller may time its own control code as Profiler::CONTROL):
+    Profiler                  profiler;
+
   protected:
 
     /** Triggers a note (called either directly in noteOn or in getSample when the sequencer is 
@@ -296,6 +384,79 @@ namespace rosic
 
     void calculateEnvModScalerAndOffset();
 
+    /** Sets up the ramps of the nominal cutoff, the envelope scaler and offset and the resonance 
+    from their current towards their target values. */
+    void startParameterRamp();
+
+    /** Moves the ramped parameters one modulation update further towards their targets. */
+    INLINE void advanceParameterRamp();
+
+    /** Sets the ramped parameters to their targets right away. */
+    void jumpToParameterTargets();
+
+    /** Sets up the sample rate of the objects in the modulation chain, which run at the sample 
+    rate divided by the modulation interval. */
+    void updateModulationSampleRate();
+
+    /** Sets up highpass1 and postFilter, whose frequencies don't change with the notes, from
+    a coefficient set for the current sample rate and highpass cutoffs - taken from
+    commonCoefficientSets when there is one for them, computed otherwise. */
+    void updateFixedFilters();
+
+    /** The coefficients of highpass1 and postFilter for one sample rate and setting of the 
+    highpass cutoffs. */
+    struct FixedCoefficientSet
+    {
+      double sampleRate, preFilterHighpassCutoff, postFilterHighpassCutoff;
+      double highpass1[3];      // b0, b1, a1 (at the oversampled rate)
+      double postFilter[2][5];  // b0, b1, b2, a1, a2 for both stages
+    };
+
+    /** Computes a coefficient set (with temporary filter objects as designers). */
+    static void computeFixedCoefficientSet(FixedCoefficientSet& set);
+
+    /** The coefficient sets for the common sample rates and the default highpass cutoffs. They
+    are computed once during static initialization and never change afterwards, so
+    updateFixedFilters reads them without locking. */
+    struct CommonCoefficientSets
+    {
+      CommonCoefficientSets();
+      static const int numSets = 5;
+      FixedCoefficientSet sets[numSets];
+    };
+    static const CommonCoefficientSets commonCoefficientSets;
+
+    /** Evaluates the modulation chain and sets up the linear interpolation of cutoff and amplitude
+    towards the new values over the next modulationInterval samples. On the first update of a new 
+    note, cutoff and amplitude jump to the new values instead, such that the attack isn't smeared
+    over the interval. */
+    INLINE void updateModulation();
+
+    /** Like updateModulation(), but with the outputs of mainEnv, rc1, rc2 and ampEnv already 
+    computed (processBlock renders them ahead for all updates within a sub-block). */
+    INLINE void updateModulation(double mainEnvOut, double rc1Out, double rc2Out, 
+      double ampEnvOut);
+
+    /** Advances the slew limiter and the modulation chain by one sample, sets up oscillator and 
+    filter accordingly and returns the amplitude envelope for the sample. */
+    INLINE double advanceModulators();
+
+    /** Advances the slew limiter by one sample and sets up the oscillator. */
+    INLINE void advancePitch();
+
+    /** Advances the interpolated cutoff and amplitude by one sample (after the modulation chain 
+    has been updated, if due), sets up the filter and returns the amplitude. */
+    INLINE double advanceInterpolation();
+
+    /** Implements processBlock for the given oscillator kernel. */
+    template<int oscillatorKernel>
+    void processBlockWithKernel(double* out, int numSamples);
+
+    /** Runs the oversampled part of getSample (oscillator, pre-filter highpass and filter) with the
+    given oscillator kernel and returns the last of the oversampled values. */
+    template<int oscillatorKernel>
+    INLINE double getOversampledSample();
+
     /** Updates the normalizer n1 according to the time-constant of rc1 and the decay-time of the
     main envelope generator. */
     void updateNormalizer1();
@@ -308,34 +469,35 @@ namespace rosic
 
 
     static const int oversampling = 4;
+    static const int maxSubBlockSize = 64; // for the amplitudes in processBlock
+
 
     double tuning;           // master tunung for A4 in Hz
-    double ampScaler;        // final volume as raw factor
-    double oscFreq;          // frequecy of the oscillator (without pitchbend)
     double sampleRate;       // the (non-oversampled) sample rate
     double level;            // master volume level (in dB)
     double levelByVel;       // velocity dependence of the level (in dB)
     double accent;           // scales all "byVel" parameters
     double slideTime;        // the time to slide from one note to another (in ms)
-    double cutoff;           // nominal cutoff frequency of the filter
+    double resonance;        // resonance of the filter in percent (target for smoothedResonance)
+    double smoothedResonance; // resonance on its way to resonance
+    double cutoffFactor;     // factor for smoothedCutoff per ramp step
+    double envOffsetInc;     // increment for envOffset per ramp step
+    double envScalerInc;     // increment for envScaler per ramp step
+    double resonanceInc;     // increment for smoothedResonance per ramp step
     double envMod;           // strength of the envelope modulation in percent
     double envUpFraction;    // fraction of the envelope that goes upward
-    double envOffset;        // offset for the normalized envelope ('bipolarity' parameter)
-    double envScaler;        // scale-factor for the normalized envelope (derived from envMod)
     double normalAttack;     // attack time for the filter envelope on non-accented notes
     double accentAttack;     // attack time for the filter envelope on accented notes
     double normalDecay;      // decay time for the filter envelope on non-accented notes
     double accentDecay;      // decay time for the filter envelope on accented notes
     double normalAmpRelease; // amp-env release time for non-accented notes
     double accentAmpRelease; // amp-env release time for accented notes
-    double accentGain;       // between 0.0...1.0 - to scale the 3rd amp-envelope on accents
-    double pitchWheelFactor; // scale factor for oscillator frequency from pitch-wheel
-    double n1, n2;           // normalizers for the RCs that are driven by the MEG
+    double preFilterHighpassCutoff;  // cutoff of highpass1 in Hz
+    double postFilterHighpassCutoff; // cutoff of the highpass in postFilter in Hz
+    int    smoothingLength;  // number of samples over which parameter changes are ramped
     int    currentNote;      // note which is currently played (-1 if none)
     int    noteOffCountDown; // a countdown variable till next note-off in sequencer mode
     bool   slideToNextNote;  // indicate that we need to slide to the next note in sequencer mode
-    bool   idle;             // flag to indicate that we have currently nothing to do in getSample
-    bool   envModDirty;      // flag to defer calculateEnvModScalerAndOffset to getSample
 
     std::list<MidiNoteEvent> noteList;
 
@@ -358,61 +520,168 @@ namespace rosic
 
 
 
-  inline double Open303::getSample()
+  template<int oscillatorKernel>
+  INLINE double Open303::getOversampledSample()
   {
-    //if( sequencer.getSequencerMode() == AcidSequencer::OFF && ampEnv.endIsReached() )
-    //  return 0.0;
-    if( idle )
-      return 0.0;
+    double tmp;
+    for(int i=1; i<=oversampling; i++)
+    {
+      tmp  = -oscillator.getSample<oscillatorKernel>(); // the raw oscillator signal 
+      profiler.lap(Profiler::OSCILLATOR);
+      tmp  = highpass1.getSample(tmp);        // pre-filter highpass
+      tmp  = filter.getSample(tmp);           // now it's filtered
+      profiler.lap(Profiler::FILTER);
+      //tmp  = antiAliasFilter.getSample(tmp);  // anti-aliasing filtered
+
+    }
+    return tmp;
+  }
+
+  INLINE void Open303::updateModulation()
+  {
+    double mainEnvOut = mainEnv.getSample();
+    double rc1Out     = rc1.getSample(mainEnvOut);
+    double rc2Out     = rc2.getSample(accentGain > 0.0 ? mainEnvOut : 0.0);
+    double ampEnvOut  = ampEnv.getSample();
+    updateModulation(mainEnvOut, rc1Out, rc2Out, ampEnvOut);
+  }
 
+  INLINE void Open303::updateModulation(double mainEnvOut, double rc1Out, double rc2Out, 
+    double ampEnvOut)
+  {
     if( envModDirty )
     {
-      calculateEnvModScalerAndOffset();
+      if( rampParameters )
+        startParameterRamp();
+      else
+        jumpToParameterTargets();
       envModDirty = false;
     }
+    if( rampCountDown > 0 )
+      advanceParameterRamp();
 
-    // calculate instantaneous oscillator frequency and set up the oscillator:
-    double instFreq = pitchSlewLimiter.getSample(oscFreq);
-    oscillator.setFrequency(instFreq*pitchWheelFactor);
-    oscillator.calculateIncrement();
-
-    // calculate instantaneous cutoff frequency from the nominal cutoff and all its modifiers and 
-    // set up the filter:
-    double mainEnvOut = mainEnv.getSample();
-    double tmp1       = n1 * rc1.getSample(mainEnvOut);
-    double tmp2       = 0.0;
-    if( accentGain > 0.0 )
-      tmp2 = mainEnvOut;
-    tmp2 = n2 * rc2.getSample(tmp2);  
+    // calculate instantaneous cutoff frequency from the nominal cutoff and all its modifiers:
+    double tmp1 = n1 * rc1Out;
+    double tmp2 = n2 * rc2Out;  
     tmp1 = envScaler * ( tmp1 - envOffset );  // seems not to work yet
     tmp2 = accentGain*tmp2;
-    double instCutoff = cutoff * exp(0.69314718055994530941723212145818 * (tmp1+tmp2));
-    filter.setCutoff(instCutoff);
+    double newCutoff = smoothedCutoff * exp(0.69314718055994530941723212145818 * (tmp1+tmp2));
 
-    double ampEnvOut = ampEnv.getSample();
     //ampEnvOut += 0.45*filterEnvOut + accentGain*6.8*filterEnvOut; 
     if( ampEnv.isNoteOn() )
       ampEnvOut += (0.45 + 4 * accentGain) * mainEnvOut; 
     ampEnvOut = ampDeClicker.getSample(ampEnvOut);
 
-    // oversampled calculations:
-    double tmp;
-    for(int i=1; i<=oversampling; i++)
+    // interpolate towards the new values (at the full rate and on a note trigger, the new values
+    // are used directly):
+    if( modulationInterval == 1 || modulationJump )
     {
-      tmp  = -oscillator.getSample();         // the raw oscillator signal 
-      tmp  = highpass1.getSample(tmp);        // pre-filter highpass
-      tmp  = filter.getSample(tmp);           // now it's filtered
-      //tmp  = antiAliasFilter.getSample(tmp);  // anti-aliasing filtered
+      instCutoff     = newCutoff;
+      instCutoffInc  = 0.0;
+      instAmp        = ampEnvOut;
+      instAmpInc     = 0.0;
+      modulationJump = false;
+    }
+    else
+    {
+      double scaler = 1.0 / modulationInterval;
+      instCutoffInc = scaler * (newCutoff - instCutoff);
+      instAmpInc    = scaler * (ampEnvOut - instAmp);
+    }
+    modulationCountDown = modulationInterval;
+  }
+
+  INLINE void Open303::advanceParameterRamp()
+  {
+    rampCountDown--;
+    if( rampCountDown > 0 )
+    {
+      smoothedCutoff *= cutoffFactor;
+      envScaler      += envScalerInc;
+      envOffset      += envOffsetInc;
+      if( resonanceInc != 0.0 )
+      {
+        smoothedResonance += resonanceInc;
+        filter.setResonance(smoothedResonance, true);
+        profiler.count(Profiler::COEFFICIENT_UPDATES);
+      }
+    }
+    else
+      jumpToParameterTargets(); // avoids accumulating rounding errors
+  }
+
+  INLINE double Open303::advanceModulators()
+  {
+    advancePitch();
+    if( modulationCountDown == 0 )
+      updateModulation();
+    return advanceInterpolation();
+  }
+
+  INLINE void Open303::advancePitch()
+  {
+    // calculate instantaneous oscillator frequency and set up the oscillator (unless the slew 
+    // limiter has settled - then the increment stays valid until the next pitch change):
+    if( !pitchSettled )
+    {
+      double instFreq = pitchSlewLimiter.getSample(oscFreq);
+      if( pitchSlewLimiter.snapIfConverged(oscFreq, 1.e-12) )
+      {
+        instFreq     = oscFreq;
+        pitchSettled = true;
+      }
+      oscillator.setFrequency(instFreq*pitchWheelFactor);
+      oscillator.calculateIncrement();
+    }
+  }
 
+  INLINE double Open303::advanceInterpolation()
+  {
+    modulationCountDown--;
+    instCutoff += instCutoffInc;
+    instAmp    += instAmpInc;
+    profiler.lap(Profiler::MODULATION);
+#ifdef ROSIC_PROFILE
+    if( instCutoff != filter.getCutoff() ) // setCutoff recalculates the coefficients
+      profiler.count(Profiler::COEFFICIENT_UPDATES);
+#endif
+    filter.setCutoff(instCutoff);
+    profiler.lap(Profiler::COEFFICIENTS);
+    return instAmp;
+  }
+
+  inline double Open303::getSample()
+  {
+    //if( sequencer.getSequencerMode() == AcidSequencer::OFF && ampEnv.endIsReached() )
+    //  return 0.0;
+    profiler.countSamples(1);
+    if( idle )
+      return 0.0;
+
+    profiler.start();
+    double ampEnvOut = advanceModulators();
+
+    // oversampled calculations - the oscillator kernel is chosen once for all of them:
+    double tmp;
+    switch( oscillator.getKernel() )
+    {
+    case 0:  tmp = getOversampledSample<0>(); break;
+    case 1:  tmp = getOversampledSample<1>(); break;
+    case 2:  tmp = getOversampledSample<2>(); break;
+    case 3:  tmp = getOversampledSample<3>(); break;
+    case 4:  tmp = getOversampledSample<4>(); break;
+    case 5:  tmp = getOversampledSample<5>(); break;
+    case 6:  tmp = getOversampledSample<6>(); break;
+    case 7:  tmp = getOversampledSample<7>(); break;
+    default: tmp = getOversampledSample<8>();
     }
 
     // these filters may actually operate without oversampling (but only if we reset them in
     // triggerNote - avoid clicks)
-    tmp  = allpass.getSample(tmp);
-    tmp  = highpass2.getSample(tmp);        
-    tmp  = notch.getSample(tmp);
+    tmp  = postFilter.getSample(tmp);       // allpass, highpass and notch
     tmp *= ampEnvOut;                       // amplified
     tmp *= ampScaler;
+    profiler.lap(Profiler::POST_CHAIN);
 
     // find out whether we may switch ourselves off for the next call:
     idle = ampEnv.endIsReached() && fabs(tmp) < 0.000001;
@@ -0,0 +1,75 @@
+#include "rosic_Profiler.h"
+using namespace rosic;
+
+#ifdef ROSIC_PROFILE
+
+#include <chrono>
+
+const double Profiler::averageWeight = 0.2; // about one second to settle
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+Profiler::Profiler()
+{
+  lapStart      = readTimer();
+  windowSamples = 0;
+  for(int i=0; i<NUM_STAGES; i++)
+  {
+    ticks[i] = 0;
+    averages[i].store(0.0);
+  }
+  for(int i=0; i<NUM_COUNTERS; i++)
+  {
+    counts[i] = 0;
+    countRates[i].store(0.0);
+    totalCounts[i].store(0);
+  }
+  windowStartTicks       = readTimer();
+  windowStartNanoseconds = readClockNanoseconds();
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+void Profiler::finishWindow()
+{
+  // the timer runs at a constant rate, which is measured against the clock over each window (the
+  // window also contains the time that the thread spent elsewhere, but that doesn't matter here):
+  unsigned long long nowTicks       = readTimer();
+  unsigned long long nowNanoseconds = readClockNanoseconds();
+  double windowNanoseconds = (double) (nowNanoseconds - windowStartNanoseconds);
+  double windowTicks       = (double) (nowTicks - windowStartTicks);
+  windowStartTicks         = nowTicks;
+  windowStartNanoseconds   = nowNanoseconds;
+  if( windowTicks <= 0.0 || windowNanoseconds <= 0.0 )
+    return;
+
+  double nanosecondsPerTick = windowNanoseconds / windowTicks;
+  double scaler             = nanosecondsPerTick / windowSamples;
+  for(int i=0; i<NUM_STAGES; i++)
+  {
+    double average = averages[i].load();
+    averages[i].store(average + averageWeight * (scaler * ticks[i] - average));
+    ticks[i] = 0;
+  }
+
+  double perSecond = 1.e9 / windowNanoseconds;
+  for(int i=0; i<NUM_COUNTERS; i++)
+  {
+    double rate = countRates[i].load();
+    countRates[i].store(rate + averageWeight * (perSecond * counts[i] - rate));
+    totalCounts[i].store(totalCounts[i].load() + counts[i]);
+    counts[i] = 0;
+  }
+
+  windowSamples = 0;
+}
+
+unsigned long long Profiler::readClockNanoseconds()
+{
+  return (unsigned long long) std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef rosic_Profiler_h
+#define rosic_Profiler_h
+
+// standard-library includes:
+#ifdef ROSIC_PROFILE
+#include <atomic>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define ROSIC_PROFILER_TSC
+#elif defined(__aarch64__)
+#define ROSIC_PROFILER_CNTVCT
+#endif
+#endif
+
+// rosic-indcludes:
+#include "GlobalDefinitions.h"
+
+namespace rosic
+{
+
+  /**
+
+  This class measures where the time of the calling thread goes when it renders audio. The thread
+  calls start() when it begins, lap() with the stage that has just finished after each stage and
+  countSamples() for every sample (or block) it renders. The times of the stages are summed up
+  over windows of windowLength samples and fed into moving averages, which another thread can read
+  as nanoseconds per sample. In addition, events like coefficient recalculations can be counted.
+
+  The measurement only exists when the code is compiled with ROSIC_PROFILE defined (PROFILE=1 in
+  the Makefile). Otherwise all functions are empty and vanish from the processing code. The timer
+  is the time stamp counter on x86 and the virtual counter on AArch64, which cost a few
+  nanoseconds per read - as there are several reads per sample, the profiled build runs
+  noticeably slower and the stage times include this overhead. Compare stages with each other
+  rather than with the normal build.
+
+  */
+
+  class Profiler
+  {
+
+  public:
+
+    /** The stages of the rendering, in the order of processing. */
+    enum stages
+    {
+      MODULATION = 0,   // slew limiter, envelopes and parameter ramps
+      COEFFICIENTS,     // filter coefficients for the new cutoff
+      OSCILLATOR,       // oversampled oscillator
+      FILTER,           // oversampled pre-filter highpass and ladder filter
+      POST_CHAIN,       // post filters and amplification
+      CONTROL,          // control block of the caller (parameter updates)
+
+      NUM_STAGES
+    };
+
+    /** The events that can be counted. */
+    enum counters
+    {
+      COEFFICIENT_UPDATES = 0, // recalculations of the ladder filter coefficients
+      WAVETABLE_REBUILDS,      // rebuilt mip-maps that were swapped in
+
+      NUM_COUNTERS
+    };
+
+#ifdef ROSIC_PROFILE
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    Profiler();
+
+    //---------------------------------------------------------------------------------------------
+    // measurement (on the rendering thread):
+
+    /** Starts timing the first stage. */
+    INLINE void start() { lapStart = readTimer(); }
+
+    /** Adds the time since the last call to start() or lap() to the given stage. */
+    INLINE void lap(int stage)
+    {
+      unsigned long long now = readTimer();
+      ticks[stage] += now - lapStart;
+      lapStart      = now;
+    }
+
+    /** Counts occurrences of the given event. */
+    INLINE void count(int counter, int number = 1) { counts[counter] += number; }
+
+    /** Counts rendered samples and updates the averages at the end of each window. */
+    INLINE void countSamples(int numSamples)
+    {
+      windowSamples += numSamples;
+      if( windowSamples >= windowLength )
+        finishWindow();
+    }
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry (on any thread):
+
+    /** Returns the moving average of the time spent in the given stage in nanoseconds per
+    sample. */
+    double getNanosecondsPerSample(int stage) const { return averages[stage].load(); }
+
+    /** Returns the moving average of the number of given events per second. */
+    double getCountPerSecond(int counter) const { return countRates[counter].load(); }
+
+    /** Returns the number of given events since construction. */
+    long long getTotalCount(int counter) const { return totalCounts[counter].load(); }
+
+    //=============================================================================================
+
+  protected:
+
+    /** Converts the ticks of the window to nanoseconds (with the clock as reference) and updates
+    the averages. */
+    void finishWindow();
+
+    /** Returns the current value of the timer in ticks. */
+    static INLINE unsigned long long readTimer()
+    {
+#if defined(ROSIC_PROFILER_TSC)
+      return __rdtsc();
+#elif defined(ROSIC_PROFILER_CNTVCT)
+      unsigned long long t;
+      __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(t));
+      return t;
+#else
+      return readClockNanoseconds();
+#endif
+    }
+
+    /** Returns the current time of the steady clock in nanoseconds. */
+    static unsigned long long readClockNanoseconds();
+
+    static const int windowLength = 8192; // samples per window, about 0.2 seconds
+    static const double averageWeight;    // weight of the newest window in the averages
+
+    // written by the rendering thread only:
+    unsigned long long lapStart;
+    unsigned long long ticks[NUM_STAGES];
+    int                counts[NUM_COUNTERS];
+    int                windowSamples;
+    unsigned long long windowStartTicks;
+    unsigned long long windowStartNanoseconds;
+
+    // read by other threads:
+    std::atomic<double>    averages[NUM_STAGES];
+    std::atomic<double>    countRates[NUM_COUNTERS];
+    std::atomic<long long> totalCounts[NUM_COUNTERS];
+
+#else
+
+    INLINE void start() {}
+    INLINE void lap(int /*stage*/) {}
+    INLINE void count(int /*counter*/, int /*number*/ = 1) {}
+    INLINE void countSamples(int /*numSamples*/) {}
+
+#endif
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include "rosic_WaveFileReader.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+using namespace rosic;
+
+namespace
+{
+  const int formatPcm        = 0x0001;
+  const int formatFloat      = 0x0003;
+  const int formatExtensible = 0xFFFE;
+
+  // little endian decoding:
+  uint32_t readUInt16(const unsigned char* b) { return b[0] | (b[1] << 8); }
+  uint32_t readUInt32(const unsigned char* b)
+  {
+    return (uint32_t) b[0] | ((uint32_t) b[1] << 8) | ((uint32_t) b[2] << 16) 
+      | ((uint32_t) b[3] << 24);
+  }
+
+  double decodeSample(const unsigned char* b, int format, int bytesPerSample)
+  {
+    if( format == formatFloat )
+    {
+      if( bytesPerSample == 4 )
+      {
+        uint32_t bits = readUInt32(b);
+        float    value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+      }
+      uint64_t bits = readUInt32(b) | ((uint64_t) readUInt32(b+4) << 32);
+      double   value;
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+
+    switch( bytesPerSample )
+    {
+    case 1:  return (b[0] - 128) / 128.0; // 8 bit is unsigned
+    case 2:  return (int16_t) readUInt16(b) / 32768.0;
+    case 3:  return (int32_t) (((uint32_t) b[0] << 8) | ((uint32_t) b[1] << 16) 
+               | ((uint32_t) b[2] << 24)) / 2147483648.0;
+    default: return (int32_t) readUInt32(b) / 2147483648.0;
+    }
+  }
+}
+
+bool WaveFileReader::readMono(const char* path, std::vector<double>& samples, int maxNumFrames, 
+                              double* sampleRate)
+{
+  samples.clear();
+  FILE* file = fopen(path, "rb");
+  if( file == NULL )
+    return false;
+
+  unsigned char header[12];
+  if(    fread(header, 1, 12, file) != 12 
+      || memcmp(header, "RIFF", 4) != 0 || memcmp(header+8, "WAVE", 4) != 0 )
+  {
+    fclose(file);
+    return false;
+  }
+
+  // walk through the chunks until we have seen 'fmt ' and reach 'data':
+  int  format = 0, numChannels = 0, bytesPerSample = 0;
+  bool ok     = false;
+  unsigned char chunkHeader[8];
+  while( fread(chunkHeader, 1, 8, file) == 8 )
+  {
+    uint32_t chunkSize = readUInt32(chunkHeader+4);
+    if( memcmp(chunkHeader, "fmt ", 4) == 0 )
+    {
+      unsigned char fmt[40];
+      memset(fmt, 0, sizeof(fmt));
+      uint32_t numToRead = chunkSize < sizeof(fmt) ? chunkSize : sizeof(fmt);
+      if( chunkSize < 16 || fread(fmt, 1, numToRead, file) != numToRead )
+        break;
+      format         = readUInt16(fmt);
+      numChannels    = readUInt16(fmt+2);
+      bytesPerSample = readUInt16(fmt+14) / 8;
+      if( format == formatExtensible && chunkSize >= 26 )
+        format = readUInt16(fmt+24); // the first two bytes of the sub-format GUID
+      if( sampleRate != NULL )
+        *sampleRate = readUInt32(fmt+4);
+      uint32_t numToSkip = chunkSize - numToRead + (chunkSize & 1);
+      if( numToSkip > 0 && fseek(file, numToSkip, SEEK_CUR) != 0 )
+        break;
+    }
+    else if( memcmp(chunkHeader, "data", 4) == 0 )
+    {
+      bool formatIsValid = numChannels > 0 && numChannels <= 32
+        && (   (format == formatPcm   && bytesPerSample >= 1 && bytesPerSample <= 4)
+            || (format == formatFloat && (bytesPerSample == 4 || bytesPerSample == 8)) );
+      if( !formatIsValid )
+        break;
+
+      int frameSize = numChannels * bytesPerSample;
+      uint32_t numFrames = chunkSize / frameSize;
+      if( numFrames == 0 || numFrames > (uint32_t) maxNumFrames )
+        break;
+
+      // stream the frames through a small buffer:
+      samples.reserve(numFrames);
+      unsigned char buffer[4096];
+      int framesPerChunk = sizeof(buffer) / frameSize;
+      uint32_t numRemaining = numFrames;
+      while( numRemaining > 0 )
+      {
+        uint32_t n = numRemaining < (uint32_t) framesPerChunk ? numRemaining : framesPerChunk;
+        if( fread(buffer, frameSize, n, file) != n )
+          break;
+        for(uint32_t i=0; i<n; i++)
+        {
+          double sum = 0.0;
+          for(int c=0; c<numChannels; c++)
+            sum += decodeSample(buffer + i*frameSize + c*bytesPerSample, format, bytesPerSample);
+          samples.push_back(sum / numChannels);
+        }
+        numRemaining -= n;
+      }
+      ok = numRemaining == 0;
+      break;
+    }
+    else if( fseek(file, chunkSize + (chunkSize & 1), SEEK_CUR) != 0 ) // chunks are word-aligned
+      break;
+  }
+
+  fclose(file);
+  if( !ok )
+    samples.clear();
+  return ok;
+}
@@ -0,0 +1,36 @@
+#ifndef rosic_WaveFileReader_h
+#define rosic_WaveFileReader_h
+
+// standard-library includes:
+#include <stddef.h>
+#include <vector>
+
+namespace rosic
+{
+
+  /**
+
+  This is a minimal reader for RIFF/WAVE files. It understands integer PCM with 8, 16, 24 and 32
+  bits and IEEE float with 32 and 64 bits (also in the WAVE_FORMAT_EXTENSIBLE wrapper) and mixes
+  all channels down to mono. The file is read in small chunks, so no buffer for the whole file
+  is needed.
+
+  */
+
+  class WaveFileReader
+  {
+
+  public:
+
+    /** Reads the sample frames of the file at the given path into 'samples' (as mono mix in the 
+    range -1...+1) and stores the sample-rate in 'sampleRate', if not NULL. Returns false, when 
+    the file can't be read, has an unsupported format, contains no samples or more than 
+    'maxNumFrames' frames - 'samples' is left empty then. */
+    static bool readMono(const char* path, std::vector<double>& samples, int maxNumFrames, 
+                         double* sampleRate = NULL);
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_WaveFileReader_h
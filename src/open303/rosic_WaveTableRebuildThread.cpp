@@ -0,0 +1,170 @@
+#include "rosic_WaveTableRebuildThread.h"
+#include "rosic_MipMapCache.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+WaveTableRebuildThread::WaveTableRebuildThread()
+{
+  numJobs   = 0;
+  busyTable = NULL;
+  running   = false;
+  quit      = false;
+  fourierTransformer.setBlockSize(MipMappedWaveTable::tableLength);
+}
+
+WaveTableRebuildThread::~WaveTableRebuildThread()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    quit = true;
+  }
+  condition.notify_all();
+  if( thread.joinable() )
+    thread.join();
+}
+
+WaveTableRebuildThread& WaveTableRebuildThread::getInstance()
+{
+  static WaveTableRebuildThread instance;
+  return instance;
+}
+
+//-------------------------------------------------------------------------------------------------
+// job handling:
+
+void WaveTableRebuildThread::start()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if( !running )
+  {
+    thread  = std::thread(&WaveTableRebuildThread::run, this);
+    running = true;
+  }
+}
+
+bool WaveTableRebuildThread::tryPost(MipMappedWaveTable* table,
+                                     const MipMappedWaveTable::WaveformParameters& p,
+                                     int numTables, int generation)
+{
+  std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+  if( !lock.owns_lock() )
+    return false;
+
+  // a waiting job for the same table is outdated - just update its parameters:
+  for(int i=0; i<numJobs; i++)
+  {
+    if( jobs[i].table == table )
+    {
+      jobs[i].parameters = p;
+      jobs[i].numTables  = numTables;
+      jobs[i].generation = generation;
+      return true;
+    }
+  }
+
+  if( numJobs >= maxNumJobs )
+    return false;
+  jobs[numJobs].table      = table;
+  jobs[numJobs].parameters = p;
+  jobs[numJobs].numTables  = numTables;
+  jobs[numJobs].generation = generation;
+  numJobs++;
+
+  lock.unlock();
+  condition.notify_all();
+  return true;
+}
+
+void WaveTableRebuildThread::cancel(MipMappedWaveTable* table)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+
+  int j = 0;
+  for(int i=0; i<numJobs; i++)
+  {
+    if( jobs[i].table != table )
+      jobs[j++] = jobs[i];
+  }
+  numJobs = j;
+
+  condition.wait(lock, [&]{ return busyTable != table; });
+}
+
+//-------------------------------------------------------------------------------------------------
+// the thread function:
+
+void WaveTableRebuildThread::run()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while( true )
+  {
+    condition.wait(lock, [&]{ return quit || numJobs > 0; });
+    if( quit )
+      break;
+
+    // pop the oldest job:
+    Job job = jobs[0];
+    for(int i=1; i<numJobs; i++)
+      jobs[i-1] = jobs[i];
+    numJobs--;
+    busyTable = job.table;
+    lock.unlock();
+
+    // use the baked or cached tables, if possible - render them otherwise (user waveforms are
+    // neither baked nor cached):
+    bool isUserWaveform = job.parameters.waveform == MipMappedWaveTable::USER;
+    MipMapCache& cache  = MipMapCache::getInstance();
+    const double* shared = NULL;
+    if( !isUserWaveform )
+    {
+      shared = MipMappedWaveTable::getBakedMipMap(job.parameters);
+      if( shared == NULL )
+        shared = cache.find(job.parameters);
+    }
+    bool failed = false;
+    if( shared == NULL && isUserWaveform )
+    {
+      // only the tables that the oscillator can reach:
+      double* target = job.table->acquireSpareMipMap(job.numTables);
+      if( target != NULL )
+      {
+        job.table->renderUserPrototype(prototype);
+        MipMappedWaveTable::generateMipMap(prototype, target, &fourierTransformer, job.numTables);
+      }
+      shared = target;
+      failed = target == NULL;
+    }
+    else if( shared == NULL )
+    {
+      // the cache serves all sample rates, so it gets all tables:
+      MipMappedWaveTable::renderPrototype(job.parameters, prototype);
+      MipMappedWaveTable::generateMipMap(prototype, completeMipMap, &fourierTransformer);
+      shared = cache.store(job.parameters, completeMipMap);
+      if( shared == NULL )
+      {
+        // cache is full, use our own copy:
+        double* target = job.table->acquireSpareMipMap(job.numTables);
+        if( target != NULL )
+          MipMappedWaveTable::copyMipMap(completeMipMap, target, job.numTables);
+        shared = target;
+        failed = target == NULL;
+      }
+    }
+
+    // our own buffers with an outdated number of tables are thrown away (the shared mip-maps are
+    // complete), the table has posted the job again in this case:
+    if( failed )
+      job.table->rebuildFailed();
+    else if( job.table->isOwnedMipMap(shared) 
+      && job.generation != job.table->getRebuildGeneration() )
+      job.table->releaseSpareMipMap(shared);
+    else
+      job.table->publishMipMap(shared);
+
+    lock.lock();
+    busyTable = NULL;
+    condition.notify_all();
+  }
+}
@@ -0,0 +1,96 @@
+#ifndef rosic_WaveTableRebuildThread_h
+#define rosic_WaveTableRebuildThread_h
+
+// standard-library includes:
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// rosic-indcludes:
+#include "rosic_MipMappedWaveTable.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a process-wide worker thread that renders the mip-maps of MipMappedWaveTable objects
+  which have asynchronous rebuilding switched on. Jobs are posted without blocking, so the audio
+  thread may change waveform parameters. The thread renders into a spare buffer of the table and
+  hands it back via MipMappedWaveTable::publishMipMap() - the table swaps it in on its next call
+  to updateMipMap().
+
+  */
+
+  class WaveTableRebuildThread
+  {
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Returns the one and only instance. */
+    static WaveTableRebuildThread& getInstance();
+
+    /** Destructor. Stops the thread. */
+    ~WaveTableRebuildThread();
+
+    //---------------------------------------------------------------------------------------------
+    // job handling:
+
+    /** Starts the thread, if it is not already running. */
+    void start();
+
+    /** Queues a rebuild of the given table with the given parameters, number of tables and 
+    generation (@see MipMappedWaveTable::getRebuildGeneration). A job for the same table that is 
+    still waiting is replaced. This function never blocks and doesn't allocate, so it may be called
+    from the audio thread - it returns false when the queue could not be accessed or is full, in 
+    which case the caller should try again later. */
+    bool tryPost(MipMappedWaveTable* table, const MipMappedWaveTable::WaveformParameters& p,
+                 int numTables, int generation);
+
+    /** Removes all waiting jobs for the given table and waits until a job for this table that
+    may currently be running is finished. This blocks, so it is meant for switching asynchronous
+    rebuilding off and for the destruction of the table - not for the audio thread. */
+    void cancel(MipMappedWaveTable* table);
+
+    //=============================================================================================
+
+  protected:
+
+    /** Constructor. Protected because this is a singleton. */
+    WaveTableRebuildThread();
+
+    /** The thread function. */
+    void run();
+
+    struct Job
+    {
+      MipMappedWaveTable* table;
+      MipMappedWaveTable::WaveformParameters parameters;
+      int numTables;  // number of tables for our own buffers of the table
+      int generation; // outdated, when it differs from the table's generation at the end
+    };
+
+    static const int maxNumJobs = 64;
+
+    Job  jobs[maxNumJobs];   // the waiting jobs in the order of posting
+    int  numJobs;            // number of waiting jobs
+    MipMappedWaveTable* busyTable; // the table, we are currently rendering for (if any)
+    bool running, quit;
+
+    std::thread             thread;
+    std::mutex              mutex;
+    std::condition_variable condition;
+
+    // work area for the rendering:
+    double prototype[MipMappedWaveTable::tableLength+4];
+    double completeMipMap[MipMappedWaveTable::mipMapSize];
+    FourierTransformerRadix2 fourierTransformer;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_WaveTableRebuildThread_h
@@ -1,4 +1,5 @@
 #include "plugin.hpp"
+#include "rosic_MipMapCache.h"
 
 // Define the global plugin instance
 Plugin* pluginInstance;
@@ -11,6 +12,12 @@ extern "C" __attribute__((visibility("default"))) uint32_t rack_plugin_abi_versi
 extern "C" __attribute__((visibility("default"))) void init(Plugin* p) {
 	pluginInstance = p;
 
-	// Register the module model
+	// Register the module models
 	p->addModel(modelAcidEngine);
+	p->addModel(modelAcidEngineMidi);
+
+	// Map the wavetables rendered in earlier sessions, so new instances don't have to render them again
+	std::string cacheDirectory = asset::user(p->slug);
+	system::createDirectories(cacheDirectory);
+	rosic::MipMapCache::getInstance().open(system::join(cacheDirectory, "mipmaps.bin"));
 }
@@ -5,5 +5,6 @@ using namespace rack;
 // Declare the global plugin instance (defined in plugin.cpp)
 extern Plugin* pluginInstance;
 
-// Declare the model (defined in AcidEngine.cpp)
+// Declare the models (defined in AcidEngine.cpp and AcidEngineMidi.cpp)
 extern Model* modelAcidEngine;
+extern Model* modelAcidEngineMidi;
@@ -0,0 +1,80 @@
+// Renders the mip-maps of the default SAW303 and SQUARE303 waveforms and writes them as C++
+// source, such that MipMappedWaveTable doesn't have to do any FFT work for them at runtime. Run by
+// the Makefile with the host compiler - see BAKED_WAVETABLES there.
+//
+// Usage: BakeWaveTables <output.cpp>
+
+#include <stdio.h>
+#include "rosic_MipMappedWaveTable.h"
+
+using namespace rosic;
+
+// gives access to the (protected) rendering functions and the default parameters
+class WaveTableBaker : public MipMappedWaveTable
+{
+public:
+
+  WaveTableBaker(int waveformToBake)
+  {
+    parameters.waveform = waveformToBake;
+  }
+
+  bool write(FILE* file, const char* name)
+  {
+    static double prototype[tableLength+4];
+    static double mipMap[mipMapSize];
+    renderPrototype(parameters, prototype);
+    generateMipMap(prototype, mipMap, &fourierTransformer);
+
+    fprintf(file, "static const double %s[%d] =\n{\n", name, mipMapSize);
+    for(int i=0; i<mipMapSize; i++)
+      fprintf(file, "  %.17g,\n", mipMap[i]);
+    return fprintf(file, "};\n\n") > 0;
+  }
+
+  bool writeEntry(FILE* file, const char* name)
+  {
+    return fprintf(file, "  { { %d, %.17g, %.17g, %.17g, %.17g }, %s },\n", parameters.waveform,
+      parameters.symmetry, parameters.tanhShaperFactor, parameters.tanhShaperOffset,
+      parameters.squarePhaseShift, name) > 0;
+  }
+
+  static int getMipMapSize() { return mipMapSize; }
+};
+
+int main(int argc, char** argv)
+{
+  if( argc != 2 )
+  {
+    fprintf(stderr, "Usage: %s <output.cpp>\n", argv[0]);
+    return 1;
+  }
+  FILE* file = fopen(argv[1], "w");
+  if( file == NULL )
+  {
+    perror(argv[1]);
+    return 1;
+  }
+
+  WaveTableBaker saw303(MipMappedWaveTable::SAW303);
+  WaveTableBaker square303(MipMappedWaveTable::SQUARE303);
+
+  bool ok = fprintf(file, "// Generated by tools/BakeWaveTables.cpp - do not edit.\n\n"
+    "#include \"rosic_BakedWaveTables.h\"\n\nnamespace rosic\n{\n\n") > 0;
+  ok = ok && saw303.write(file, "saw303MipMap");
+  ok = ok && square303.write(file, "square303MipMap");
+  ok = ok && fprintf(file, "const BakedMipMap bakedMipMaps[] =\n{\n") > 0;
+  ok = ok && saw303.writeEntry(file, "saw303MipMap");
+  ok = ok && square303.writeEntry(file, "square303MipMap");
+  ok = ok && fprintf(file, "};\n\nconst int numBakedMipMaps = 2;\nconst int bakedMipMapSize = %d;\n"
+    "\n} // end namespace rosic\n", WaveTableBaker::getMipMapSize()) > 0;
+  ok = (fclose(file) == 0) && ok;
+
+  if( !ok )
+  {
+    fprintf(stderr, "Could not write %s\n", argv[1]);
+    remove(argv[1]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,102 @@
+// Measures the cost of decaying filter tails with and without a DenormalGuard. Each scenario
+// excites a filter with a short burst and then feeds it silence, like a long release tail after
+// the last note. Build it twice to compare the filters with and without their TINY offsets - see
+// the benchmark target in the Makefile.
+//
+// Usage: DenormalBenchmark [seconds]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "rosic_DenormalGuard.h"
+#include "rosic_TeeBeeFilter.h"
+#include "rosic_OnePoleFilter.h"
+#include "rosic_BiquadCascade.h"
+
+using namespace rosic;
+
+static const double sampleRate = 44100.0;
+
+// excites the filter with a short burst, then returns the time per sample (in nanoseconds) for
+// filtering numSamples samples of silence
+template<class Filter>
+double measureTail(Filter& filter, int numSamples, double& sink)
+{
+  for(int n=0; n<64; n++)
+    sink += filter.getSample(n%2 == 0 ? 1.0 : -1.0);
+
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for(int n=0; n<numSamples; n++)
+    sink += filter.getSample(0.0);
+  std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1-t0).count() / numSamples;
+}
+
+template<class Filter>
+void runScenario(const char* name, void (*setUp)(Filter&), int numSamples)
+{
+  double sink = 0.0;
+  double times[2];
+  for(int guarded=0; guarded<2; guarded++)
+  {
+    Filter filter;
+    setUp(filter);
+    if( guarded )
+    {
+      DenormalGuard denormalGuard;
+      times[guarded] = measureTail(filter, numSamples, sink);
+    }
+    else
+      times[guarded] = measureTail(filter, numSamples, sink);
+  }
+  printf("%-28s %10.2f %10.2f %8.1fx\n", name, times[0], times[1], times[0]/times[1]);
+  if( sink == 12345.678 )  // keep the results alive
+    printf("\n");
+}
+
+static void setUpLadder(TeeBeeFilter& filter)
+{
+  filter.setSampleRate(2*sampleRate);  // oversampled, as in Open303
+  filter.setMode(TeeBeeFilter::TB_303);
+  filter.setCutoff(500.0);
+  filter.setResonance(50.0);
+  filter.setFeedbackHighpassCutoff(150.0);
+}
+
+static void setUpHighpass(OnePoleFilter& filter)
+{
+  filter.setSampleRate(sampleRate);
+  filter.setMode(OnePoleFilter::HIGHPASS);
+  filter.setCutoff(24.167);
+}
+
+static void setUpCascade(BiquadCascade& filter)
+{
+  // two resonant lowpass stages at 1 kHz:
+  double w = 2*PI*1000.0/sampleRate, alpha = sin(w)/(2*4.0), c = cos(w), s = 1.0/(1.0+alpha);
+  filter.setNumStages(2);
+  for(int i=0; i<2; i++)
+    filter.setStageCoefficients(i, 0.5*(1-c)*s, (1-c)*s, 0.5*(1-c)*s, 2*c*s, (alpha-1)*s);
+}
+
+int main(int argc, char** argv)
+{
+  double seconds  = argc > 1 ? atof(argv[1]) : 10.0;
+  int numSamples  = (int) (seconds*sampleRate);
+  if( numSamples <= 0 )
+  {
+    fprintf(stderr, "Usage: %s [seconds]\n", argv[0]);
+    return 1;
+  }
+
+#ifdef ROSIC_NO_DENORMAL_OFFSETS
+  printf("filters without TINY offsets, %.1f s tails\n", seconds);
+#else
+  printf("filters with TINY offsets, %.1f s tails\n", seconds);
+#endif
+  printf("%-28s %10s %10s %9s\n", "ns/sample", "unguarded", "guarded", "ratio");
+  runScenario<TeeBeeFilter> ("TB_303 ladder (2x rate)", setUpLadder,   2*numSamples);
+  runScenario<OnePoleFilter>("one-pole highpass",       setUpHighpass, numSamples);
+  runScenario<BiquadCascade>("biquad cascade",          setUpCascade,  numSamples);
+  return 0;
+}
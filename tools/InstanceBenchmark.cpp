@@ -0,0 +1,77 @@
+// Renders many Open303 voices side by side, one sample of each voice at a time, the way a host
+// runs many module instances. With enough voices their state no longer fits into the level 1 and
+// level 2 caches, so this measures how well the per-sample state of one voice is packed. The
+// timings alone don't tell whether a layout change saves cache misses - run it under a profiler
+// with hardware counters for that, e.g. for 64, 1024 and 4096 voices:
+//   perf stat -e L1-dcache-load-misses,LLC-load-misses InstanceBenchmark 4096 0.5
+// The access-frequency layout of Open303 has not been checked this way yet.
+//
+// Usage: InstanceBenchmark [numVoices] [seconds]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "rosic_Open303.h"
+
+using namespace rosic;
+
+static const double sampleRate = 44100.0;
+
+int main(int argc, char** argv)
+{
+  int    numVoices = argc > 1 ? atoi(argv[1]) : 64;
+  double seconds   = argc > 2 ? atof(argv[2]) : 2.0;
+  int    numFrames = (int) (seconds*sampleRate);
+  if( numVoices <= 0 || numFrames <= 0 )
+  {
+    fprintf(stderr, "Usage: %s [numVoices] [seconds]\n", argv[0]);
+    return 1;
+  }
+
+  // allocated one by one, like module instances:
+  std::vector<Open303*> voices(numVoices);
+  for(int v=0; v<numVoices; v++)
+  {
+    voices[v] = new Open303;
+    voices[v]->setSampleRate(sampleRate);
+    voices[v]->setWaveform(v%2 == 0 ? 0.0 : 1.0);
+    voices[v]->setCutoff(300.0 + 20.0*(v%32));
+    voices[v]->setResonance(60.0);
+    voices[v]->setEnvMod(50.0);
+    voices[v]->setDecay(400.0);
+    voices[v]->setAmpDecay(4000.0);
+    voices[v]->setAmpRelease(15.0);
+  }
+
+  // sixteenth notes at 120 bpm, every voice on its own note, gate high for half a step:
+  static const int notes[16] = { 36, 48, 39, 36, 43, 36, 51, 46, 36, 36, 48, 41, 36, 53, 39, 34 };
+  int stepLength = (int) (0.125*sampleRate);
+  double sink = 0.0;
+
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for(int n=0; n<numFrames; n++)
+  {
+    int step     = n / stepLength;
+    int position = n % stepLength;
+    for(int v=0; v<numVoices; v++)
+    {
+      if( position == 0 )
+        voices[v]->noteOn(notes[(step+v)%16], (step+v)%3 == 0 ? 127 : 80);
+      else if( position == stepLength/2 )
+        voices[v]->noteOn(notes[(step+v)%16], 0);
+      sink += voices[v]->getSample();
+    }
+  }
+  std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+  double ns = std::chrono::duration<double, std::nano>(t1-t0).count();
+  printf("%d voices, %.1f s: %.2f ns per voice and sample (%.1f%% of real time)\n", numVoices, 
+    seconds, ns/((double)numFrames*numVoices), 100.0*ns*1.e-9/seconds);
+  if( sink == 12345.678 )  // keep the results alive
+    printf("\n");
+
+  for(int v=0; v<numVoices; v++)
+    delete voices[v];
+  return 0;
+}
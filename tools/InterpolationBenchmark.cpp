@@ -0,0 +1,155 @@
+// Compares the interpolation methods of MipMappedWaveTable for the table length it is built with
+// (ROSIC_WAVETABLE_LENGTH). For each method it measures the time per lookup, reading the table
+// like an oscillator does, and the signal-to-noise ratio of the lookups against the exact
+// band-limited interpolation of the same table (its Fourier series). The SNR is measured on the
+// tables that hold the harmonics below 128 and below 32, such that builds with different table
+// lengths compare at equal harmonic content - see the benchmark target in the Makefile, which
+// builds it for both supported lengths.
+//
+// Usage: InterpolationBenchmark [lookups in millions]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "rosic_MipMappedWaveTable.h"
+
+using namespace rosic;
+
+static const int tableLength = ROSIC_WAVETABLE_LENGTH;
+
+// reads the table with the given method at successive phases (as an oscillator at about 1 kHz
+// would) and returns the time per lookup in nanoseconds
+template<int method>
+double measureTime(MipMappedWaveTable& table, int tableIndex, int numLookups, double& sink)
+{
+  double increment = tableLength * 1000.0 / 44100.0;
+  double phase     = 0.0;
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for(int n=0; n<numLookups; n++)
+  {
+    int intIndex = (int) phase;
+    sink  += table.getValue<method>(intIndex, phase-intIndex, tableIndex);
+    phase += increment;
+    if( phase >= tableLength )
+      phase -= tableLength;
+  }
+  std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1-t0).count() / numLookups;
+}
+
+// returns the SNR in dB of the lookups at the given positions against the reference values
+template<int method>
+double measureSnr(MipMappedWaveTable& table, int tableIndex, const std::vector<double>& positions,
+                  const std::vector<double>& reference)
+{
+  double signal = 0.0, noise = 0.0;
+  for(size_t i=0; i<positions.size(); i++)
+  {
+    int    intIndex = (int) positions[i];
+    double error    = table.getValue<method>(intIndex, positions[i]-intIndex, tableIndex)
+                      - reference[i];
+    signal += reference[i]*reference[i];
+    noise  += error*error;
+  }
+  return 10.0 * log10(signal/noise);
+}
+
+// evaluates the Fourier series of the table with the given index at random positions
+void computeReference(MipMappedWaveTable& table, int tableIndex, int numHarmonics,
+                      std::vector<double>& positions, std::vector<double>& reference)
+{
+  // the samples of the table are the lookups at integer positions:
+  std::vector<double> samples(tableLength);
+  for(int n=0; n<tableLength; n++)
+    samples[n] = table.getValueLinear(n, 0.0, tableIndex);
+
+  std::vector<double> a(numHarmonics, 0.0), b(numHarmonics, 0.0);
+  for(int k=0; k<numHarmonics; k++)
+  {
+    for(int n=0; n<tableLength; n++)
+    {
+      double w = 2.0*M_PI*k*n/tableLength;
+      a[k] += samples[n]*cos(w);
+      b[k] += samples[n]*sin(w);
+    }
+    a[k] *= (k == 0 ? 1.0 : 2.0) / tableLength;
+    b[k] *= 2.0 / tableLength;
+  }
+
+  srand(1);
+  for(size_t i=0; i<positions.size(); i++)
+  {
+    double x = tableLength * (rand() / (RAND_MAX+1.0));
+    double y = 0.0;
+    for(int k=0; k<numHarmonics; k++)
+    {
+      double w = 2.0*M_PI*k*x/tableLength;
+      y += a[k]*cos(w) + b[k]*sin(w);
+    }
+    positions[i] = x;
+    reference[i] = y;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int numLookups = (int) ((argc > 1 ? atof(argv[1]) : 20.0) * 1.e6);
+  if( numLookups <= 0 )
+  {
+    fprintf(stderr, "Usage: %s [lookups in millions]\n", argv[0]);
+    return 1;
+  }
+
+  MipMappedWaveTable table;
+  table.setWaveform(MipMappedWaveTable::SAW303);
+
+  static const char* names[3] = { "linear", "cubic Hermite", "Lagrange" };
+  static const int harmonicLimits[2] = { 128, 32 };
+  double sink = 0.0;
+  for(int method=MipMappedWaveTable::LINEAR; method<=MipMappedWaveTable::LAGRANGE; method++)
+  {
+    printf("length %4d, %-13s:", tableLength, names[method]);
+    for(int h=0; h<2; h++)
+    {
+      // table t holds the harmonics below tableLength/2^(t+1):
+      int tableIndex = 0;
+      while( (tableLength >> (tableIndex+1)) > harmonicLimits[h] )
+        tableIndex++;
+
+      std::vector<double> positions(20000), reference(20000);
+      computeReference(table, tableIndex, harmonicLimits[h], positions, reference);
+      double snr;
+      switch( method )
+      {
+      case MipMappedWaveTable::CUBIC_HERMITE:
+        snr = measureSnr<MipMappedWaveTable::CUBIC_HERMITE>(table, tableIndex, positions, reference);
+        break;
+      case MipMappedWaveTable::LAGRANGE:
+        snr = measureSnr<MipMappedWaveTable::LAGRANGE>(table, tableIndex, positions, reference);
+        break;
+      default:
+        snr = measureSnr<MipMappedWaveTable::LINEAR>(table, tableIndex, positions, reference);
+      }
+      printf("  SNR %5.1f dB (harmonics < %3d)", snr, harmonicLimits[h]);
+    }
+
+    double ns;
+    switch( method )
+    {
+    case MipMappedWaveTable::CUBIC_HERMITE:
+      ns = measureTime<MipMappedWaveTable::CUBIC_HERMITE>(table, 0, numLookups, sink);
+      break;
+    case MipMappedWaveTable::LAGRANGE:
+      ns = measureTime<MipMappedWaveTable::LAGRANGE>(table, 0, numLookups, sink);
+      break;
+    default:
+      ns = measureTime<MipMappedWaveTable::LINEAR>(table, 0, numLookups, sink);
+    }
+    printf("  %.2f ns per lookup\n", ns);
+  }
+  if( sink == 12345.678 )  // keep the results alive
+    printf("\n");
+  return 0;
+}
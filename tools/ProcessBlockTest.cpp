@@ -0,0 +1,134 @@
+// Checks that Open303::processBlock renders the same signal as successive calls to getSample. Two
+// engines play the same acid sequence (accents, slides, note-offs and parameter changes between
+// the blocks), one of them sample by sample and the other in blocks of varying sizes, for every
+// modulation interval. processBlock renders the envelopes and RCs in closed form, so the outputs
+// differ by rounding - the test fails when the difference exceeds a small fraction of the peak.
+// At the end of a release, getSample switches the engine off on the first quiet sample while
+// processBlock does so at the end of the block, so the samples in which the sample-by-sample
+// engine is off (its output is exactly zero) are not compared.
+//
+// Usage: ProcessBlockTest [sample rate]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include "rosic_Open303.h"
+
+using namespace rosic;
+
+static const double tolerance = 1.e-9; // maximum difference relative to the peak
+
+// sets up the parameters for the given step of the sequence
+void setUpStep(Open303& engine, int step)
+{
+  engine.setWaveform((step/16 % 3) * 0.5);
+  engine.setCutoff(300.0 + 100.0 * (step%16));
+  engine.setResonance(40.0 + 3.0 * (step%16));
+  engine.setDecay(300.0 + 50.0 * (step/16));
+  engine.setAccentDecay(60.0 + 10.0 * (step/16));
+  engine.setEnvMod(20.0 + 4.0 * (step%16));
+  engine.setAccent(50.0);
+}
+
+// plays the sequence on the engine and returns the output, rendered by getSample when blockSizes
+// is NULL and by processBlock in blocks of the given sizes (cycled through) otherwise
+std::vector<double> render(double sampleRate, int modulationInterval, const int* blockSizes,
+                           int numBlockSizes)
+{
+  static const int notes[16] = { 36, 48, 39, 36, 43, 36, 51, 46, 36, 36, 48, 41, 36, 53, 39, 34 };
+
+  Open303 engine;
+  engine.setSampleRate(sampleRate);
+  engine.setModulationInterval(modulationInterval);
+  engine.setParameterSmoothing(64);
+  engine.setAttack(3.0);    // as the modules set it up
+  engine.setAmpAttack(3.0);
+  engine.setAmpDecay(4000.0);
+  engine.setAmpRelease(15.0);
+
+  int stepLength = (int) (0.125 * sampleRate);
+  std::vector<double> out(48*stepLength + (int) sampleRate);
+  double* position = &out[0];
+  int     block    = 0;
+  for(int step=0; step<=48; step++)
+  {
+    int length = stepLength;
+    if( step == 48 )
+      length = (int) sampleRate; // the tail
+    else
+    {
+      setUpStep(engine, step);
+      bool accent = step % 3 == 0;
+      if( step % 5 == 4 )
+        engine.setSlideTime(200.0);
+      else
+      {
+        engine.setSlideTime(60.0);
+        engine.allNotesOff();
+      }
+      engine.noteOn(notes[step%16], accent ? 127 : 80);
+    }
+
+    // the note-off falls into the middle of the step:
+    for(int half=0; half<2; half++)
+    {
+      int numSamples = half == 0 ? length/2 : length - length/2;
+      if( blockSizes == NULL )
+      {
+        for(int n=0; n<numSamples; n++)
+          *position++ = engine.getSample();
+      }
+      else
+      {
+        while( numSamples > 0 )
+        {
+          int n = blockSizes[block++ % numBlockSizes];
+          if( n > numSamples )
+            n = numSamples;
+          engine.processBlock(position, n);
+          position   += n;
+          numSamples -= n;
+        }
+      }
+      if( half == 0 && step < 48 )
+        engine.noteOn(notes[step%16], 0);
+    }
+  }
+  return out;
+}
+
+int main(int argc, char** argv)
+{
+  double sampleRate = argc > 1 ? atof(argv[1]) : 44100.0;
+  if( sampleRate <= 0.0 )
+  {
+    fprintf(stderr, "Usage: %s [sample rate]\n", argv[0]);
+    return 1;
+  }
+
+  // sizes below, at and above the sub-blocks of processBlock, in an order that moves the block
+  // boundaries against the modulation updates:
+  static const int blockSizes[] = { 1, 7, 64, 3, 100, 32, 65, 13, 256, 2 };
+  static const int numBlockSizes = sizeof(blockSizes) / sizeof(blockSizes[0]);
+
+  bool passed = true;
+  for(int interval=1; interval<=16; interval++)
+  {
+    std::vector<double> reference = render(sampleRate, interval, NULL, 0);
+    std::vector<double> blocks    = render(sampleRate, interval, blockSizes, numBlockSizes);
+
+    double peak = 0.0, maxDifference = 0.0;
+    for(size_t n=0; n<reference.size(); n++)
+    {
+      peak          = fmax(peak, fabs(reference[n]));
+      if( reference[n] != 0.0 )
+        maxDifference = fmax(maxDifference, fabs(blocks[n]-reference[n]));
+    }
+    bool ok = peak > 0.0 && maxDifference <= tolerance * peak;
+    printf("modulation interval %2d: peak %.3f, max. difference %.3g  %s\n", interval, peak,
+           maxDifference, ok ? "ok" : "FAILED");
+    passed = passed && ok;
+  }
+  return passed ? 0 : 1;
+}